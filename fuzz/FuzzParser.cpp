@@ -0,0 +1,92 @@
+#include "ArchiveAnalyzer.h"
+#include "ExtractorRegistry.h"
+#include "PerceptualHash.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iterator>
+#include <span>
+#include <string_view>
+#include <vector>
+
+// One fuzz target per format: build with -DFUZZ_FORMAT=<jpeg|png|bmp|gif|wav|zip|pdf|txt>
+#ifndef FUZZ_FORMAT
+#error "FUZZ_FORMAT must name the format to fuzz"
+#endif
+
+#define FUZZ_STRINGIFY_VALUE(x) #x
+#define FUZZ_STRINGIFY(x) FUZZ_STRINGIFY_VALUE(x)
+
+namespace {
+
+struct FuzzFormat {
+    const char* target;    // FUZZ_FORMAT value
+    const char* extractor; // registry name
+    const char* fileName;  // passed to the parser as the file name
+};
+
+constexpr FuzzFormat formats[] = {
+    {"jpeg", "JPEG", "fuzz.jpg"},
+    {"png",  "PNG",  "fuzz.png"},
+    {"bmp",  "BMP",  "fuzz.bmp"},
+    {"gif",  "GIF",  "fuzz.gif"},
+    {"wav",  "WAV",  "fuzz.wav"},
+    {"zip",  "ZIP",  "fuzz.zip"},
+    {"pdf",  "PDF",  "fuzz.pdf"},
+    {"txt",  "TXT",  "fuzz.txt"},
+};
+
+constexpr std::size_t findFormat(std::string_view target) {
+    std::size_t index = 0;
+    while (index < std::size(formats) && target != formats[index].target) {
+        ++index;
+    }
+    return index;
+}
+
+constexpr std::size_t formatIndex = findFormat(FUZZ_STRINGIFY(FUZZ_FORMAT));
+static_assert(formatIndex < std::size(formats), "Unknown FUZZ_FORMAT");
+constexpr const FuzzFormat& format = formats[formatIndex];
+
+} // namespace
+
+/**
+ * @brief Runs every parser of one format over an arbitrary buffer.
+ *
+ * The metadata parser gets a private copy of exactly the `readSize` prefix the registry
+ * would hand it, so AddressSanitizer reports any read past its declared bound. Images are
+ * also decoded for perceptual hashing and archives are walked member by member.
+ * Exceptions are how parsers reject malformed input and are not findings.
+ */
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, std::size_t size) {
+    const std::span<const uint8_t> bytes(data, size);
+    const ExtractorDescriptor* extractor = ExtractorRegistry::instance().find(format.extractor);
+    if (!extractor) {
+        return 0;
+    }
+
+    const std::vector<uint8_t> prefix(data, data + std::min(size, extractor->readSize));
+    try {
+        extractor->parse(prefix, format.fileName);
+    } catch (const std::exception&) {
+    }
+
+    switch (extractor->type) {
+    case FileType::JPEG:
+    case FileType::PNG:
+    case FileType::BMP:
+    case FileType::GIF:
+        computePerceptualHash(extractor->type, bytes);
+        break;
+    case FileType::ZIP:
+        try {
+            analyzeArchiveMembers(bytes, format.fileName);
+        } catch (const std::exception&) {
+        }
+        break;
+    default:
+        break;
+    }
+    return 0;
+}
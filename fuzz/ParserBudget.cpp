@@ -0,0 +1,230 @@
+#include "ExtractorRegistry.h"
+#include <unistd.h>
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+namespace {
+
+/**
+ * @brief What parsing one file of a format may cost.
+ *
+ * Bounded (Header) formats get a fixed byte budget whatever the file size; whole-file
+ * formats get a multiple of the file size. Time budgets are for a warm page cache.
+ */
+struct Budget {
+    const char* format;
+    std::uint64_t fixedBytes;
+    double bytesPerFileByte;
+    double fixedMillis;
+    double millisPerMiB;
+};
+
+constexpr Budget budgets[] = {
+    {"JPEG", 72 << 10, 0.0,  1.0, 0.0}, // walks APP segments up to JPEGMaxHeaderRegion for the frame size
+    {"PNG",  16 << 10, 0.0,  1.0, 0.0},
+    {"BMP",  16 << 10, 0.0,  1.0, 0.0},
+    {"GIF",  16 << 10, 0.0,  1.0, 0.0},
+    {"WAV",  16 << 10, 0.0,  1.0, 0.0},
+    {"TXT",  16 << 10, 0.0,  1.0, 0.0},
+    {"ZIP",  64 << 10, 1.0,  5.0, 5.0},
+    {"PDF",  64 << 10, 2.0, 20.0, 50.0},
+};
+
+// Zeros appended to bounded formats; a parser that reads them is no longer bounded
+constexpr std::size_t paddingBytes = 8 << 20;
+constexpr int repetitions = 5;
+
+const Budget* budgetFor(std::string_view format) {
+    for (const Budget& budget : budgets) {
+        if (format == budget.format) {
+            return &budget;
+        }
+    }
+    return nullptr;
+}
+
+// Bytes this process has read through read(2) and friends, or nullopt without /proc/self/io
+std::optional<std::uint64_t> bytesReadSoFar() {
+    std::ifstream io("/proc/self/io");
+    std::string key;
+    std::uint64_t value = 0;
+    while (io >> key >> value) {
+        if (key == "rchar:") {
+            return value;
+        }
+    }
+    return std::nullopt;
+}
+
+struct Measurement {
+    std::optional<std::uint64_t> bytesRead;
+    double millis = 0;
+    std::string error;
+};
+
+/**
+ * @brief Analyzes a file like the CLI does and keeps the cheapest of several runs.
+ *
+ * @param probeCost What reading /proc/self/io itself adds to rchar.
+ */
+Measurement measure(const std::filesystem::path& filePath, std::uint64_t probeCost) {
+    Measurement result;
+    result.millis = std::numeric_limits<double>::max();
+    for (int run = 0; run < repetitions; ++run) {
+        const std::optional<std::uint64_t> before = bytesReadSoFar();
+        const auto start = std::chrono::steady_clock::now();
+        try {
+            ExtractorRegistry::instance().analyze(filePath);
+        } catch (const std::exception& e) {
+            result.error = e.what();
+        }
+        const double millis = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        const std::optional<std::uint64_t> after = bytesReadSoFar();
+
+        result.millis = std::min(result.millis, millis);
+        if (before && after) {
+            const std::uint64_t bytes = *after - *before - std::min(*after - *before, probeCost);
+            result.bytesRead = std::min(result.bytesRead.value_or(bytes), bytes);
+        }
+    }
+    return result;
+}
+
+struct Check {
+    std::string label;
+    std::string format;
+    std::uint64_t fileSize = 0;
+    Measurement measurement;
+    std::uint64_t byteBudget = 0;
+    double timeBudget = 0;
+
+    bool overBytes() const { return measurement.bytesRead && *measurement.bytesRead > byteBudget; }
+    bool overTime() const { return measurement.millis > timeBudget; }
+};
+
+void printCheck(const Check& check) {
+    std::cout << std::left << std::setw(32) << check.label << std::setw(6) << check.format << std::right
+              << std::setw(12) << check.fileSize
+              << std::setw(12) << (check.measurement.bytesRead ? std::to_string(*check.measurement.bytesRead) : "n/a")
+              << std::setw(12) << check.byteBudget
+              << std::setw(10) << std::fixed << std::setprecision(3) << check.measurement.millis
+              << std::setw(10) << check.timeBudget;
+    if (check.overBytes() || check.overTime()) {
+        std::cout << "  OVER BUDGET (" << (check.overBytes() ? "bytes" : "") << (check.overBytes() && check.overTime() ? ", " : "")
+                  << (check.overTime() ? "time" : "") << ")";
+    } else if (!check.measurement.error.empty()) {
+        std::cout << "  rejected: " << check.measurement.error;
+    }
+    std::cout << std::endl;
+}
+
+} // namespace
+
+/**
+ * @brief Checks every parser against its format's bytes-read and time budget.
+ *
+ * Each file is analyzed through `ExtractorRegistry::analyze`, exactly as the CLI does.
+ * Bytes are what the kernel returned to the process (`rchar`), so buffered over-reads by
+ * poppler or libzip count too. Files of bounded formats are run again with megabytes of
+ * trailing zeros appended, which catches parsers that quietly started reading whole files.
+ *
+ * Usage: parser_budget [--time-scale=<factor>] <file or directory>...
+ * Exits with 1 if any file is over budget.
+ */
+int main(int argc, char* argv[]) {
+    double timeScale = 1.0;
+    std::vector<std::filesystem::path> files;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg.starts_with("--time-scale=")) {
+            const std::string_view value = arg.substr(std::string_view("--time-scale=").size());
+            const auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), timeScale);
+            if (ec != std::errc() || end != value.data() + value.size() || timeScale <= 0) {
+                std::cerr << "Invalid time scale: " << value << std::endl;
+                return 1;
+            }
+            continue;
+        }
+
+        std::error_code ec;
+        if (std::filesystem::is_directory(arg, ec)) {
+            for (const auto& entry : std::filesystem::recursive_directory_iterator(arg, ec)) {
+                if (entry.is_regular_file(ec)) {
+                    files.push_back(entry.path());
+                }
+            }
+        } else {
+            files.emplace_back(arg);
+        }
+    }
+    if (files.empty()) {
+        std::cerr << "Usage: " << argv[0] << " [--time-scale=<factor>] <file or directory>..." << std::endl;
+        return 1;
+    }
+    std::sort(files.begin(), files.end());
+
+    const std::optional<std::uint64_t> probeStart = bytesReadSoFar();
+    const std::optional<std::uint64_t> probeEnd = bytesReadSoFar();
+    const std::uint64_t probeCost = probeStart && probeEnd ? *probeEnd - *probeStart : 0;
+    if (!probeStart) {
+        std::cerr << "/proc/self/io is not available; only time budgets are checked" << std::endl;
+    }
+
+    const std::filesystem::path paddedDir = std::filesystem::temp_directory_path() / ("parser_budget." + std::to_string(getpid()));
+    std::filesystem::create_directories(paddedDir);
+
+    std::vector<Check> checks;
+    for (const std::filesystem::path& filePath : files) {
+        std::vector<uint8_t> bytes;
+        const ExtractorDescriptor* extractor = ExtractorRegistry::instance().identify(filePath, bytes);
+        const Budget* budget = extractor ? budgetFor(extractor->name) : nullptr;
+        if (!budget) {
+            std::cerr << "No budget for " << filePath.string() << std::endl;
+            continue;
+        }
+
+        std::vector<std::filesystem::path> variants{filePath};
+        if (extractor->cost == CostClass::Header) {
+            const std::filesystem::path padded = paddedDir / filePath.filename();
+            readFilePrefix(filePath, SIZE_MAX, bytes);
+            bytes.resize(bytes.size() + paddingBytes);
+            std::ofstream(padded, std::ios::binary).write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+            variants.push_back(padded);
+        }
+
+        for (const std::filesystem::path& variant : variants) {
+            Check check;
+            check.label = variant == filePath ? filePath.filename().string() : filePath.filename().string() + " (+8 MiB)";
+            check.format = extractor->name;
+            check.fileSize = std::filesystem::file_size(variant);
+            check.measurement = measure(variant, probeCost);
+            check.byteBudget = budget->fixedBytes + static_cast<std::uint64_t>(budget->bytesPerFileByte * static_cast<double>(check.fileSize));
+            check.timeBudget = (budget->fixedMillis + budget->millisPerMiB * static_cast<double>(check.fileSize) / (1 << 20)) * timeScale;
+            checks.push_back(std::move(check));
+        }
+    }
+    std::filesystem::remove_all(paddedDir);
+
+    std::cout << std::left << std::setw(32) << "File" << std::setw(6) << "Type" << std::right << std::setw(12) << "Size"
+              << std::setw(12) << "Read" << std::setw(12) << "Budget" << std::setw(10) << "ms" << std::setw(10) << "Budget" << std::endl;
+    std::size_t failures = 0;
+    for (const Check& check : checks) {
+        printCheck(check);
+        failures += check.overBytes() || check.overTime();
+    }
+
+    std::cout << std::endl << checks.size() << " checks, " << failures << " over budget" << std::endl;
+    return failures ? 1 : 0;
+}
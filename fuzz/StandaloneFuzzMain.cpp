@@ -0,0 +1,53 @@
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <system_error>
+#include <vector>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, std::size_t size);
+
+namespace {
+
+void runInput(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    const std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    LLVMFuzzerTestOneInput(bytes.data(), bytes.size());
+}
+
+} // namespace
+
+/**
+ * @brief Replays inputs through a fuzz target for toolchains without libFuzzer.
+ *
+ * Arguments are files or directories (searched recursively). libFuzzer style `-flag=value`
+ * arguments are ignored so the same command line works with either engine. Crashes are
+ * reported by the sanitizers the target was built with.
+ */
+int main(int argc, char* argv[]) {
+    std::size_t inputs = 0;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg.starts_with("-")) {
+            continue;
+        }
+
+        std::error_code ec;
+        if (std::filesystem::is_directory(arg, ec)) {
+            for (const auto& entry : std::filesystem::recursive_directory_iterator(arg, ec)) {
+                if (entry.is_regular_file(ec)) {
+                    runInput(entry.path());
+                    ++inputs;
+                }
+            }
+        } else if (std::filesystem::is_regular_file(arg, ec)) {
+            runInput(arg);
+            ++inputs;
+        }
+    }
+
+    std::cerr << "Replayed " << inputs << " inputs" << std::endl;
+    return 0;
+}
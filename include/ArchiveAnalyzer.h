@@ -0,0 +1,50 @@
+#ifndef ARCHIVE_ANALYZER_H
+#define ARCHIVE_ANALYZER_H
+
+#include <filesystem>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+#include "CustomMap.h"
+
+/**
+ * @brief Limits applied while descending into archive members.
+ */
+struct ArchiveOptions {
+    unsigned maxDepth = 4;                       // nested archives deeper than this are listed but not opened
+    double maxCompressionRatio = 100.0;          // members inflating beyond this ratio are skipped (zip bomb guard)
+    std::uint64_t maxMemberBytes = 256ull << 20; // most bytes held in memory for a single member
+};
+
+/**
+ * @brief Metadata extracted from one archive member.
+ */
+struct ArchiveMemberRecord {
+    std::string path; // archive path followed by the member name, e.g. "docs.zip/a/b.pdf"
+    CustomMap<std::string, std::string> metadata;
+};
+
+/**
+ * @brief Runs the specialized analyzers over every member of a ZIP archive without extracting it.
+ *
+ * The archive is memory mapped. Stored members are analyzed straight from the mapping;
+ * compressed members are inflated lazily and only as far as the `readSize` of the
+ * extractor matching the member requires. Nested archives are descended up to `options.maxDepth`.
+ *
+ * @param archivePath The path to the ZIP archive.
+ * @param options Depth and size limits.
+ * @return One record per file member, parents listed before their nested members.
+ */
+std::vector<ArchiveMemberRecord> analyzeArchiveMembers(const std::filesystem::path& archivePath, const ArchiveOptions& options = {});
+
+/**
+ * @brief Same as above for an archive that is already in memory.
+ *
+ * @param archive The archive bytes; stored members are analyzed in place.
+ * @param name Prefix for the member paths, normally the archive's path.
+ * @param options Depth and size limits.
+ */
+std::vector<ArchiveMemberRecord> analyzeArchiveMembers(std::span<const uint8_t> archive, const std::string& name, const ArchiveOptions& options = {});
+
+#endif
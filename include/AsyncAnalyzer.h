@@ -0,0 +1,327 @@
+#ifndef ASYNC_ANALYZER_H
+#define ASYNC_ANALYZER_H
+
+#include <concepts>
+#include <coroutine>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ranges>
+#include <semaphore>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "CustomMap.h"
+
+//Enum for how far the analysis of one file got
+enum class AnalysisStatus {
+    Ok,
+    ReadFailed,  // the file could not be opened or read
+    Unsupported, // no extractor recognized the data
+    ParseFailed  // an extractor recognized the data but could not parse it
+};
+
+/**
+ * @brief Result of analyzing one file asynchronously.
+ */
+struct MetadataRecord {
+    std::filesystem::path path;
+    std::string fileType;  // extractor name, empty if the file could not be identified
+    CustomMap<std::string, std::string> metadata;
+    std::string error;     // empty on success
+    AnalysisStatus status = AnalysisStatus::Ok;
+};
+
+// MetadataRecord::error when the status is AnalysisStatus::Unsupported
+inline constexpr const char* unsupportedFormatMessage = "Unsupported file format.";
+
+/**
+ * @brief Something that runs work items, e.g. a thread pool or an event loop.
+ *
+ * Implement this to run the analyzer's I/O on your own executor.
+ */
+class Executor {
+public:
+    virtual ~Executor() = default;
+    virtual void post(std::function<void()> work) = 0;
+};
+
+/**
+ * @brief Fixed-size thread pool executor. Pending work is drained before destruction.
+ */
+class ThreadPool : public Executor {
+public:
+    explicit ThreadPool(std::size_t threadCount);
+    ~ThreadPool() override;
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void post(std::function<void()> work) override;
+
+private:
+    void run();
+
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<std::function<void()>> queue;
+    bool stopping = false;
+    std::vector<std::thread> threads;
+};
+
+/**
+ * @brief Executors used by the async API; both must outlive all work started on them.
+ */
+struct AsyncContext {
+    Executor* io;       // file reads and header parsing
+    Executor* blocking; // whole-file extractors (poppler, libzip); keep it small to bound them
+};
+
+/**
+ * @brief Process-wide context: one I/O thread per core and a two-thread blocking pool.
+ */
+AsyncContext defaultAsyncContext();
+
+/**
+ * @brief Awaitable that resumes the awaiting coroutine on `executor`.
+ */
+struct ScheduleOn {
+    Executor& executor;
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle) { executor.post([handle] { handle.resume(); }); }
+    void await_resume() const noexcept {}
+};
+
+/**
+ * @brief Lazily started coroutine producing one value of type T.
+ *
+ * Nothing runs until the task is awaited. When it finishes, the awaiting coroutine is
+ * resumed on whichever thread completed the task.
+ */
+template <typename T>
+class task {
+public:
+    struct promise_type {
+        std::optional<T> value;
+        std::exception_ptr error;
+        std::coroutine_handle<> continuation;
+
+        task get_return_object() { return task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        struct FinalAwaiter {
+            bool await_ready() const noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+                auto continuation = handle.promise().continuation;
+                return continuation ? continuation : std::noop_coroutine();
+            }
+            void await_resume() const noexcept {}
+        };
+        FinalAwaiter final_suspend() noexcept { return {}; }
+
+        template <typename U>
+        void return_value(U&& result) { value.emplace(std::forward<U>(result)); }
+        void unhandled_exception() { error = std::current_exception(); }
+    };
+
+    task(task&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+    task& operator=(task&& other) noexcept {
+        if (this != &other) {
+            if (handle) {
+                handle.destroy();
+            }
+            handle = std::exchange(other.handle, {});
+        }
+        return *this;
+    }
+    ~task() {
+        if (handle) {
+            handle.destroy();
+        }
+    }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle.promise().continuation = awaiting;
+        return handle;
+    }
+    T await_resume() {
+        if (handle.promise().error) {
+            std::rethrow_exception(handle.promise().error);
+        }
+        return std::move(*handle.promise().value);
+    }
+
+private:
+    explicit task(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+/**
+ * @brief Eagerly started coroutine that cleans up after itself; used to launch work
+ * whose result is delivered some other way.
+ */
+struct detached_task {
+    struct promise_type {
+        detached_task get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+/**
+ * @brief Coroutine that yields a sequence of values asynchronously.
+ *
+ * Consume it with `while (auto value = co_await generator.next()) { ... }`.
+ * The producer may `co_await` between yields; the consumer is resumed on whichever
+ * thread the producer yields from. Destroying the generator also destroys a suspended
+ * producer, so awaitables it can be suspended in must withdraw themselves on destruction.
+ */
+template <typename T>
+class async_generator {
+public:
+    struct promise_type {
+        std::optional<T> current;
+        std::exception_ptr error;
+        std::coroutine_handle<> consumer;
+
+        async_generator get_return_object() { return async_generator(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        struct YieldAwaiter {
+            bool await_ready() const noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+                return handle.promise().consumer;
+            }
+            void await_resume() const noexcept {}
+        };
+        YieldAwaiter final_suspend() noexcept { return {}; }
+
+        template <typename U>
+        YieldAwaiter yield_value(U&& value) {
+            current.emplace(std::forward<U>(value));
+            return {};
+        }
+        void return_void() noexcept {}
+        void unhandled_exception() { error = std::current_exception(); }
+    };
+
+    struct NextAwaiter {
+        std::coroutine_handle<promise_type> handle;
+
+        bool await_ready() const noexcept { return !handle || handle.done(); }
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> consumer) noexcept {
+            handle.promise().consumer = consumer;
+            handle.promise().current.reset();
+            return handle;
+        }
+        std::optional<T> await_resume() {
+            if (!handle || handle.done()) {
+                if (handle && handle.promise().error) {
+                    std::rethrow_exception(std::exchange(handle.promise().error, nullptr));
+                }
+                return std::nullopt;
+            }
+            return std::move(handle.promise().current);
+        }
+    };
+
+    async_generator(async_generator&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+    async_generator& operator=(async_generator&& other) noexcept {
+        if (this != &other) {
+            if (handle) {
+                handle.destroy();
+            }
+            handle = std::exchange(other.handle, {});
+        }
+        return *this;
+    }
+    ~async_generator() {
+        if (handle) {
+            handle.destroy();
+        }
+    }
+
+    // Resumes the producer; yields the next value, or nullopt once it has finished
+    NextAwaiter next() { return NextAwaiter{handle}; }
+
+private:
+    explicit async_generator(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+namespace detail {
+
+template <typename T>
+detached_task runToCompletion(task<T> work, std::optional<T>* result, std::exception_ptr* error, std::binary_semaphore* done) {
+    try {
+        result->emplace(co_await std::move(work));
+    } catch (...) {
+        *error = std::current_exception();
+    }
+    done->release();
+}
+
+} // namespace detail
+
+/**
+ * @brief Blocks the calling thread until `work` completes; for callers outside a coroutine.
+ */
+template <typename T>
+T sync_wait(task<T> work) {
+    std::optional<T> result;
+    std::exception_ptr error;
+    std::binary_semaphore done(0);
+    detail::runToCompletion(std::move(work), &result, &error, &done);
+    done.acquire();
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return std::move(*result);
+}
+
+/**
+ * @brief Analyzes one file without blocking the calling thread.
+ *
+ * The file is identified and bounded extractors run on `context.io`; whole-file
+ * extractors are handed to `context.blocking`. Failures are reported in
+ * `MetadataRecord::error` rather than thrown.
+ */
+task<MetadataRecord> analyze_async(std::filesystem::path path, AsyncContext context = defaultAsyncContext());
+
+/**
+ * @brief Analyzes many files with at most `maxInFlight` in progress at once.
+ *
+ * Records are yielded in completion order, not input order, and the consumer is always
+ * resumed on `context.io`. The generator may be destroyed before it is exhausted; files
+ * still in flight finish in the background and their records are dropped.
+ */
+async_generator<MetadataRecord> analyze_many(std::vector<std::filesystem::path> paths,
+                                             AsyncContext context = defaultAsyncContext(),
+                                             std::size_t maxInFlight = 1024);
+
+/**
+ * @brief Range overload of `analyze_many`; the range is copied before the first suspension.
+ */
+template <std::ranges::input_range R>
+    requires std::convertible_to<std::ranges::range_reference_t<R>, std::filesystem::path>
+async_generator<MetadataRecord> analyze_many(R&& paths, AsyncContext context = defaultAsyncContext(), std::size_t maxInFlight = 1024) {
+    std::vector<std::filesystem::path> copied;
+    for (auto&& path : paths) {
+        copied.emplace_back(path);
+    }
+    return analyze_many(std::move(copied), context, maxInFlight);
+}
+
+#endif
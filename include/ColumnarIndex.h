@@ -0,0 +1,140 @@
+#ifndef COLUMNAR_INDEX_H
+#define COLUMNAR_INDEX_H
+
+#include <filesystem>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "FileMetaDataAnalyzer.h"
+
+/**
+ * @brief One analyzed file as stored in the index. Unknown dimensions are 0.
+ */
+struct IndexRow {
+    std::string path;
+    std::string fileType = "UNKNOWN"; // extractor name, e.g. "PNG"
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint64_t size = 0;
+    int64_t mtime = 0; // seconds since the epoch
+};
+
+/**
+ * @brief Min/max summary of one block of rows, used to skip blocks during a query.
+ */
+struct ZoneMap {
+    uint32_t minWidth, maxWidth;
+    uint32_t minHeight, maxHeight;
+    uint64_t minSize, maxSize;
+    int64_t  minMtime, maxMtime;
+    uint64_t typeMask; // bit n set if dictionary code n occurs in the block
+};
+
+//Columns that can appear in a query predicate.
+enum class IndexColumn {
+    Type,
+    Width,
+    Height,
+    Size,
+    Mtime
+};
+
+//Comparison operators supported by a query predicate.
+enum class CompareOp {
+    Less,
+    LessEqual,
+    Greater,
+    GreaterEqual,
+    Equal,
+    NotEqual
+};
+
+/**
+ * @brief A single `column op value` filter, e.g. `width>4000`.
+ */
+struct QueryPredicate {
+    IndexColumn column;
+    CompareOp op;
+    int64_t value = 0;
+    std::string typeName; // only used for IndexColumn::Type
+};
+
+/**
+ * @brief Parses a predicate such as `type=PNG`, `width>4000`, `size<=1048576` or `mtime>-7d`.
+ *
+ * Negative mtime values with a `d`, `h` or `m` suffix are relative to the current time.
+ *
+ * @throws std::invalid_argument if the predicate cannot be parsed or its value does not fit in 64 bits.
+ */
+QueryPredicate parsePredicate(std::string_view text);
+
+/**
+ * @brief Recursively analyzes the given files and directories into index rows.
+ *
+ * Only header-cost extractors run; dimensions are taken from their `Width`/`Height` keys.
+ */
+std::vector<IndexRow> collectIndexRows(const std::vector<std::filesystem::path>& roots);
+
+/**
+ * @brief Writes rows into a columnar index file.
+ *
+ * Layout: a fixed header, a FileType dictionary, one densely packed array per column
+ * (dictionary codes, width, height, size, mtime), one zone map per block of rows and
+ * the paths as an offset array plus a string blob. Every section is 64-byte aligned so
+ * the file can be memory mapped and scanned in place.
+ *
+ * @throws std::runtime_error if the file cannot be written, or if there are more than 64
+ *         distinct file types or a type name longer than 15 characters (neither fits the dictionary).
+ */
+void writeIndex(const std::filesystem::path& indexPath, const std::vector<IndexRow>& rows);
+
+/**
+ * @brief Read-only, memory mapped view of an index written by `writeIndex`.
+ */
+class ColumnarIndex {
+public:
+    static constexpr std::size_t zoneRows = 8192;
+
+    /**
+     * @brief Maps the index file.
+     * @throws std::runtime_error if the file is missing or malformed.
+     */
+    explicit ColumnarIndex(const std::filesystem::path& indexPath);
+    ~ColumnarIndex();
+
+    ColumnarIndex(const ColumnarIndex&) = delete;
+    ColumnarIndex& operator=(const ColumnarIndex&) = delete;
+
+    std::size_t rowCount() const { return rows; }
+    std::string_view path(std::size_t row) const;
+    std::string_view typeName(std::size_t row) const;
+
+    /**
+     * @brief Returns the rows matching every predicate, in file order.
+     *
+     * Blocks whose zone map rules out a predicate are skipped; the remaining blocks
+     * are filtered one column at a time into a selection vector.
+     */
+    std::vector<uint32_t> query(const std::vector<QueryPredicate>& predicates) const;
+
+private:
+    void unmap();
+
+    const uint8_t* data = nullptr;
+    std::size_t length = 0;
+    std::size_t rows = 0;
+
+    std::vector<std::string_view> dictionary;
+    const uint8_t*  typeCodes = nullptr;
+    const uint32_t* widths = nullptr;
+    const uint32_t* heights = nullptr;
+    const uint64_t* sizes = nullptr;
+    const int64_t*  mtimes = nullptr;
+    const ZoneMap*  zones = nullptr;
+    const uint64_t* pathOffsets = nullptr;
+    const char*     pathBlob = nullptr;
+};
+
+#endif
@@ -1,3 +1,6 @@
+#ifndef CUSTOM_MAP_H
+#define CUSTOM_MAP_H
+
 #include <vector>
 #include <stdexcept> // For std::out_of_range
 #include <algorithm> // For std::find_if
@@ -146,3 +149,5 @@ public:
         return !(*this == other);
     }
 };
+
+#endif
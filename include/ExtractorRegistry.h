@@ -0,0 +1,163 @@
+#ifndef EXTRACTOR_REGISTRY_H
+#define EXTRACTOR_REGISTRY_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "FileMetaDataAnalyzer.h"
+
+//How expensive an extractor is to run, for callers that want to schedule or skip work.
+enum class CostClass {
+    Header,   // parses a bounded prefix of the file
+    Document, // needs the whole file (e.g. PDF)
+    Archive   // needs the whole file and may contain further files
+};
+
+/**
+ * @brief Everything the analyzer needs to know about one file format.
+ *
+ * `sniff` sees the first `ExtractorRegistry::sniffSize` bytes (fewer for short files).
+ * An extractor without a sniff function is the fallback used when nothing else matches.
+ * `parse` receives at least `readSize` leading bytes, or the whole file if shorter.
+ * Whole-file extractors (`readSize == SIZE_MAX`) may provide `parseFile` to use their
+ * own file API instead of having the file read into memory.
+ * `parseContent` optionally derives metadata from the decoded content (e.g. perceptual
+ * hashes of an image). It receives a read-only mapping of the whole file (empty if the file
+ * cannot be mapped) and only runs when the caller asks for it.
+ */
+struct ExtractorDescriptor {
+    const char* name = nullptr; // short upper-case format name, e.g. "PNG"
+    FileType type = FileType::UNKNOWN; // built-in formats only; plugins leave UNKNOWN
+    bool (*sniff)(std::span<const uint8_t> leadingBytes) = nullptr;
+    std::size_t readSize = 0;
+    CostClass cost = CostClass::Header;
+    CustomMap<std::string, std::string> (*parse)(std::span<const uint8_t> bytes, const std::filesystem::path& name) = nullptr;
+    CustomMap<std::string, std::string> (*parseFile)(const std::filesystem::path& filePath) = nullptr;
+    CustomMap<std::string, std::string> (*parseContent)(std::span<const uint8_t> bytes) = nullptr;
+};
+
+/**
+ * @brief Result of running the matching extractor over a file.
+ */
+struct Extraction {
+    const ExtractorDescriptor* extractor = nullptr;
+    CustomMap<std::string, std::string> metadata;
+};
+
+class ExtractorRegistry;
+
+/**
+ * @brief The built-in formats, registered by the process-wide registry in this order.
+ *
+ * Defined next to their parse functions in FileMetaDataAnalyzer.cpp.
+ */
+std::span<const ExtractorDescriptor> builtinExtractors();
+
+/**
+ * @brief Entry point a plugin shared object exports as `extern "C"` under `pluginEntryPointName`.
+ *
+ * It should call `registry.add()` for each format it provides. Descriptors must stay valid
+ * for the life of the process; plugins are never unloaded.
+ */
+using PluginEntryPoint = void (*)(ExtractorRegistry& registry);
+inline constexpr const char* pluginEntryPointName = "fma_register_extractors";
+
+/**
+ * @brief Fixed-capacity table of extractors.
+ *
+ * The process-wide instance starts with the built-in formats. Sniffing tries the most
+ * recently registered extractor first, so a plugin can claim files a built-in format
+ * would also match (e.g. a ZIP based document format). Registration is serialized and may
+ * run while other threads look extractors up: slots are never moved or reused, and a new
+ * extractor only becomes visible once its slot is complete. Lookups take no lock.
+ */
+class ExtractorRegistry {
+public:
+    static constexpr std::size_t maxExtractors = 32;
+    static constexpr std::size_t sniffSize = 16;
+
+    static ExtractorRegistry& instance();
+
+    /**
+     * @brief Registers an extractor.
+     * @return Its id, or -1 if the table is full or the descriptor has no name/parse function.
+     */
+    int add(const ExtractorDescriptor& descriptor);
+
+    /**
+     * @brief Loads a plugin shared object and runs its entry point.
+     * @throws std::runtime_error if the library or its entry point cannot be loaded.
+     */
+    void loadPlugin(const std::filesystem::path& pluginPath);
+
+    std::size_t size() const { return count.load(std::memory_order_acquire); }
+    const ExtractorDescriptor& operator[](std::size_t id) const { return extractors[id]; }
+
+    // Extractor registered for a built-in FileType, or nullptr
+    const ExtractorDescriptor* forType(FileType type) const;
+    // Extractor with the given name, or nullptr
+    const ExtractorDescriptor* find(std::string_view name) const;
+    // Latest registered extractor whose signature matches, else the fallback, else nullptr
+    const ExtractorDescriptor* sniff(std::span<const uint8_t> leadingBytes) const;
+
+    /**
+     * @brief Bytes to read up front so that sniffing and every bounded extractor with a
+     * small `readSize` can be served from a single read.
+     */
+    std::size_t prefetchSize() const { return prefetch.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Identifies a file and runs its extractor.
+     *
+     * Bounded extractors are served from one read of `prefetchSize()` bytes, read on from
+     * there if their `readSize` is larger; whole-file extractors use `parseFile` or read
+     * the rest of the file. With `withContent`, the extractor's `parseContent` also runs.
+     *
+     * @throws std::runtime_error if the file cannot be read or no extractor matches.
+     */
+    Extraction analyze(const std::filesystem::path& filePath, bool withContent = false) const;
+
+    /**
+     * @brief Reads the first `prefetchSize()` bytes of a file and sniffs them.
+     *
+     * @param filePath The path to the file.
+     * @param bytes Receives the bytes read.
+     * @return The matching extractor, or nullptr if the file cannot be read or nothing matches.
+     */
+    const ExtractorDescriptor* identify(const std::filesystem::path& filePath, std::vector<uint8_t>& bytes) const;
+
+    /**
+     * @brief Runs an extractor over a file whose leading bytes were already read, reading
+     * more only if the extractor needs it.
+     *
+     * `prefetched` is the length `bytes` was read with (normally `prefetchSize()` taken once
+     * before the read); fewer bytes than that means `bytes` already holds the whole file.
+     * With `withContent`, the file is also memory mapped for the extractor's `parseContent`,
+     * whose keys are added to the result.
+     */
+    CustomMap<std::string, std::string> extract(const ExtractorDescriptor& extractor, const std::filesystem::path& filePath, std::vector<uint8_t>& bytes,
+                                                std::size_t prefetched, bool withContent = false) const;
+
+    /**
+     * @brief Identifies and analyzes a file that is already in memory.
+     * @throws std::runtime_error if no extractor matches.
+     */
+    Extraction analyze(std::span<const uint8_t> bytes, const std::filesystem::path& name) const;
+
+private:
+    ExtractorRegistry();
+
+    std::mutex registration;
+    std::array<ExtractorDescriptor, maxExtractors> extractors{};
+    std::array<std::atomic<const ExtractorDescriptor*>, static_cast<std::size_t>(FileType::UNKNOWN) + 1> byType{};
+    std::atomic<std::size_t> count = 0; // published after the slot is written
+    std::atomic<std::size_t> prefetch = sniffSize;
+};
+
+#endif
@@ -2,14 +2,15 @@
 #define FILE_METADATA_ANALYZER_H
 
 #include <filesystem>
-#include <poppler/cpp/poppler-document.h>
 #include <cstdint>
 #include <cstring>
-#include <type_traits>
-#include <concepts>
+#include <span>
+#include <vector>
 #include "CustomMap.h"
 
-//Enumeration representing the supported file types.
+// Enumeration naming the built-in formats that other modules special-case (image hashing,
+// archive descent). Formats are declared by their extractor descriptors; a new format only
+// needs an entry here if code outside its parser has to recognize it.
 enum class FileType {
     PDF,
     TXT,
@@ -32,36 +33,44 @@ struct BasicMetadata {
     std::string lastAccess;
 };
 
-//Structure representing the header of a JPEG file.
+// Structure holding the JFIF APP0 fields and the frame size of a JPEG file.
+// It is filled field by field from big-endian byte offsets and does not mirror the on-disk layout.
 struct JPEGHeader {
-    uint16_t marker;
+    uint16_t marker;          // first marker after SOI, e.g. 0xFFE0 (APP0) or 0xFFE1 (APP1, Exif)
     uint16_t length;
-    uint8_t  identifier[5];
+    uint8_t  identifier[5];   // "JFIF\0" if the first segment is a JFIF APP0; else this and the fields up to thumbHeight are zero
     uint16_t version;
     uint8_t  units;
     uint16_t xDensity;
     uint16_t yDensity;
     uint8_t  thumbWidth;
     uint8_t  thumbHeight;
+    uint8_t  frameMarker;     // SOFn marker (0xC0-0xCF), 0 if no frame header was found
+    uint16_t width;           // from the frame header
+    uint16_t height;          // from the frame header; 0 means it is defined later by a DNL marker
 };
 
-//Structure representing the header of a PNG file.
+// APP segments (Exif, ICC profiles, thumbnails) precede the frame header; they rarely exceed this
+inline constexpr std::size_t JPEGMaxHeaderRegion = 64 * 1024;
+
+//Structure representing the header of a PNG file (signature followed by the IHDR chunk start).
 struct PNGHeader {
     uint8_t  signature[8];
-    uint32_t width;
-    uint32_t height;
+    uint32_t ihdrLength; // big-endian
+    char     ihdrType[4];
+    uint32_t width;      // big-endian
+    uint32_t height;     // big-endian
 };
 
-// Structure representing the header of a BMP file.
+// Structure holding the BMP file header and whichever DIB header variant follows it.
+// It is filled field by field from little-endian byte offsets and does not mirror the on-disk layout.
 struct BMPHeader {
     char     signature[2];
     uint32_t fileSize;
-    uint16_t reserved1;
-    uint16_t reserved2;
     uint32_t dataOffset;
-    uint32_t headerSize;
+    uint32_t dibHeaderSize;   // 12 CORE, 40 INFO, 52/56 INFO with masks, 64 OS/2, 108 V4, 124 V5
     int32_t  width;  // W
-    int32_t  height; // H
+    int32_t  height; // H, negative for top-down bitmaps
     uint16_t planes;
     uint16_t bitCount;
     uint32_t compression;
@@ -70,24 +79,19 @@ struct BMPHeader {
     int32_t  yPixelsPerMeter;
     uint32_t colorsUsed;
     uint32_t colorsImportant;
+    uint32_t redMask;
+    uint32_t greenMask;
+    uint32_t blueMask;
+    uint32_t alphaMask;
+    uint32_t colorSpaceType;  // V4 and V5 only
+    uint32_t profileOffset;   // V5 only, from the start of the DIB header
+    uint32_t profileSize;     // V5 only
+    uint32_t paletteOffset;   // derived: where the color table starts
+    uint32_t paletteEntries;  // derived: number of color table entries
 };
 
-//Structure representing the header of a ZIP file.
-struct ZIPHeader {
-    uint32_t signature;     // Always 0x04034b50
-    uint16_t versionMadeBy; // Version made by (high byte version, low byte host system)
-    uint16_t versionNeeded;  // Version needed to extract (minimum)
-    uint16_t flags;          // General purpose bit flag
-    uint16_t compressionMethod; // Compression method
-    uint16_t lastModTime;    // Last mod file time (MS-DOS time)
-    uint16_t lastModDate;    // Last mod file date (MS-DOS date)
-    uint32_t crc32;          // CRC-32 of uncompressed data
-    uint32_t compressedSize; // Compressed size
-    uint32_t uncompressedSize; // Uncompressed size
-    uint16_t fileNameLength;  // File name length
-    uint16_t extraFieldLength; // Extra field length
-};
-
+inline constexpr std::size_t BMPFileHeaderSize = 14;
+inline constexpr std::size_t BMPMaxHeaderRegion = BMPFileHeaderSize + 124; // file header + BITMAPV5HEADER
 
 //Structure representing the header of a WAV file.
 struct WAVHeader {
@@ -130,90 +134,64 @@ inline constexpr uint8_t GIFSignature[] = {0x47, 0x49, 0x46}; // "GIF" in ASCII
 
 
 
+//Little-endian field readers for byte-offset parsing; callers check bounds first.
+inline uint16_t readLE16(std::span<const uint8_t> bytes, std::size_t offset) {
+    return static_cast<uint16_t>(bytes[offset] | (bytes[offset + 1] << 8));
+}
+
+inline uint32_t readLE32(std::span<const uint8_t> bytes, std::size_t offset) {
+    return static_cast<uint32_t>(readLE16(bytes, offset)) | (static_cast<uint32_t>(readLE16(bytes, offset + 2)) << 16);
+}
+
+inline uint64_t readLE64(std::span<const uint8_t> bytes, std::size_t offset) {
+    return static_cast<uint64_t>(readLE32(bytes, offset)) | (static_cast<uint64_t>(readLE32(bytes, offset + 4)) << 32);
+}
+
+//Big-endian field readers for byte-offset parsing; callers check bounds first.
+inline uint16_t readBE16(std::span<const uint8_t> bytes, std::size_t offset) {
+    return static_cast<uint16_t>((bytes[offset] << 8) | bytes[offset + 1]);
+}
+
+inline uint32_t readBE32(std::span<const uint8_t> bytes, std::size_t offset) {
+    return (static_cast<uint32_t>(readBE16(bytes, offset)) << 16) | readBE16(bytes, offset + 2);
+}
+
 /**
- * @brief Concept to ensure the template parameter T is a valid file header type.
+ * @brief Reads at most `length` leading bytes of a file with a single read.
  *
- * The concept checks if T is one of the supported file header types: `poppler::document`, `std::ifstream`, `JPEGHeader`, `PNGHeader`, `BMPHeader`, `ZIPHeader`, or `WAVHeader`.
+ * @param filePath The path to the file.
+ * @param length The number of bytes wanted; `SIZE_MAX` reads the whole file.
+ * @param bytes Receives the bytes actually read.
+ * @return false if the file could not be opened.
  */
-template <typename T>
-concept FileHeader = std::is_same_v<T, poppler::document> ||
-                     std::is_same_v<T, std::ifstream> ||
-                     std::is_same_v<T, JPEGHeader> ||
-                     std::is_same_v<T, PNGHeader> ||
-                     std::is_same_v<T, BMPHeader> ||
-                     std::is_same_v<T, ZIPHeader> ||
-                     std::is_same_v<T, WAVHeader> ||
-                     std::is_same_v<T, GIFHeader> ||
-                     std::is_same_v<T, LogicalScreenDescriptor> ||
-                     std::is_same_v<T, BasicMetadata>;
+bool readFilePrefix(const std::filesystem::path& filePath, std::size_t length, std::vector<uint8_t>& bytes);
 
 /**
- * @brief Determines the file type of the given file path.
+ * @brief Reads on from the end of a prefix that `readFilePrefix` returned, without reading it again.
  *
- * This function uses a fold expression to check the file signature and return the corresponding `FileType`.
- *
- * @tparam T The supported file header types.
  * @param filePath The path to the file.
- * @return The determined file type.
- * *
- * This class demonstrates the use of several C++ features, including:
- * - Variadic templates: The class template parameters allow for different types of key and value.
- * - Template specialization: The class can be specialized for different key and value types.
- * - Lambda expressions: Used in the implementation of various member functions.
- * - Concepts and constraints: The class template uses the `std::is_same_v` type trait to ensure the key and value types are valid.
+ * @param length The prefix length wanted; `SIZE_MAX` reads the rest of the file.
+ * @param bytes The leading bytes of the file; receives the longer prefix.
+ * @return false if the file could not be opened.
  */
-template <typename... T>
-    requires (sizeof...(T) > 0)
-FileType determineFileType(const std::filesystem::path& filePath);
+bool extendFilePrefix(const std::filesystem::path& filePath, std::size_t length, std::vector<uint8_t>& bytes);
 
+/**
+ * @brief Parses a BMP file header and whichever DIB header variant follows it.
+ * @throws std::runtime_error if the header is truncated or the DIB header size is unknown.
+ */
+BMPHeader parseBMPHeader(std::span<const uint8_t> bytes);
 
 /**
- * @brief Analyzes the metadata of the file at the given path.
- *
- * This is a helper function that is called by the `FileMetaDataAnalyzer` class. It extracts the metadata based on the file type.
+ * @brief Walks the JPEG marker segments up to the first frame header (SOFn).
  *
- * @tparam T The file header type.
- * @param filePath The path to the file.
- * @return A `CustomMap` containing the extracted metadata.
+ * Fields whose segment is corrupt or lies beyond the end of `bytes` are left zero.
  */
-template <typename T>
-CustomMap<std::string, std::string> analyzeMetadataHelper(const std::filesystem::path& filePath);
+JPEGHeader parseJPEGHeader(std::span<const uint8_t> bytes);
 
 /**
- * @brief A class that analyzes the metadata of files.
- *
- * This class uses the `analyzeMetadataHelper()` function to extract the metadata for the supported file types.
- *
- * @tparam T The supported file header types.
+ * @brief Stats a file for its name, size, extension and times.
  */
-template <FileHeader... T>
-class FileMetaDataAnalyzer {
-public:
-    /**
-     * @brief Analyzes the metadata of the file at the given path.
-     *
-     * @param filePath The path to the file.
-     * @return A `CustomMap` containing the extracted metadata.
-     */  
-    static CustomMap<std::string, std::string> analyzeMetadata(const std::filesystem::path& filePath) {
-        CustomMap<std::string, std::string> metadata;
-
-        ((void)mergeMap(metadata, analyzeMetadataHelper<T>(filePath)), ...);
-        return metadata;
-    }
-
-private:
-    CustomMap<std::string, std::string> metadata;
-
-    static void mergeMap(CustomMap<std::string, std::string>& dest, const CustomMap<std::string, std::string>& src) {
-        for (const auto& [key, value] : src) {
-            dest[key] = value;
-        }
-    }
-
-    template <typename U>
-    friend CustomMap<std::string, std::string> analyzeMetadataHelper(const std::filesystem::path& filePath);
-    
-};
+CustomMap<std::string, std::string> analyzeBasicMetadata(const std::filesystem::path& filePath);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,57 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+/**
+ * @brief Read-only memory mapping of a whole file. Empty if the file cannot be mapped.
+ */
+class MappedFile {
+public:
+    /**
+     * @param filePath The file to map.
+     * @param advice madvise() hint describing how the caller will touch the pages.
+     */
+    explicit MappedFile(const std::filesystem::path& filePath, int advice = MADV_NORMAL) {
+        int fd = ::open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return;
+        }
+
+        struct stat fileStat;
+        if (fstat(fd, &fileStat) == 0 && fileStat.st_size > 0) {
+            void* mapping = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping != MAP_FAILED) {
+                madvise(mapping, fileStat.st_size, advice);
+                data = static_cast<const uint8_t*>(mapping);
+                size = static_cast<std::size_t>(fileStat.st_size);
+            }
+        }
+        ::close(fd);
+    }
+
+    ~MappedFile() {
+        if (data) {
+            munmap(const_cast<uint8_t*>(data), size);
+        }
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    std::span<const uint8_t> bytes() const {
+        return {data, size};
+    }
+
+private:
+    const uint8_t* data = nullptr;
+    std::size_t size = 0;
+};
+
+#endif
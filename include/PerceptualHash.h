@@ -0,0 +1,72 @@
+#ifndef PERCEPTUAL_HASH_H
+#define PERCEPTUAL_HASH_H
+
+#include <bit>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+#include "FileMetaDataAnalyzer.h"
+
+/**
+ * @brief 64-bit perceptual hashes of an image; similar images differ in few bits.
+ */
+struct PerceptualHash {
+    uint64_t dHash; // gradient hash: sign of horizontal differences on a 9x8 thumbnail
+    uint64_t pHash; // DCT hash: low 8x8 frequencies of a 32x32 thumbnail against their median
+};
+
+inline int hammingDistance(uint64_t a, uint64_t b) {
+    return std::popcount(a ^ b);
+}
+
+// 16 lower-case hex digits
+std::string formatHash(uint64_t hash);
+
+/**
+ * @brief Hashes an encoded PNG, JPEG, BMP or GIF image.
+ *
+ * Images are decoded at reduced size straight into a 32x32 luma grid: JPEG keeps only
+ * the DC coefficient of each 8x8 block (1/8 scale), GIF decodes the first frame only,
+ * PNG and BMP are box-filtered row by row. Memory stays bounded by one source row.
+ *
+ * @return The hashes, or nullopt for other formats and variants that are not decoded
+ *         (progressive/arithmetic JPEG, interlaced PNG, RLE BMP) or malformed data.
+ */
+std::optional<PerceptualHash> computePerceptualHash(FileType type, std::span<const uint8_t> bytes);
+
+/**
+ * @brief Identifies the file through the extractor registry and hashes it if it is an image.
+ */
+std::optional<PerceptualHash> computePerceptualHash(const std::filesystem::path& filePath);
+
+/**
+ * @brief An image that was hashed while looking for duplicates.
+ */
+struct HashedImage {
+    std::string path;
+    PerceptualHash hash;
+};
+
+/**
+ * @brief Hashes every image below the given files and directories, using all cores.
+ */
+std::vector<HashedImage> hashImages(const std::vector<std::filesystem::path>& roots);
+
+/**
+ * @brief Groups images whose pHashes are within `maxDistance` bits of each other, transitively.
+ *
+ * Pairs are found with a multi-index hash table: the 64 bits are split into m blocks, and
+ * each block compares the images bucketed under every value with those bucketed under values
+ * at most maxDistance / m bits away. m is chosen for the image count and distance. At a million
+ * images and 8 bits that is m = 3: about 250 bucket probes and a few candidates per image,
+ * roughly 100 MiB of tables, and seconds rather than the hours a metric tree needs. The probe
+ * count grows steeply with `maxDistance`; when no table beats it, all pairs are compared.
+ *
+ * @return Indices into `images`, one vector per group of two or more.
+ */
+std::vector<std::vector<std::size_t>> groupNearDuplicates(const std::vector<HashedImage>& images, int maxDistance);
+
+#endif
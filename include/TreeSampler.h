@@ -0,0 +1,69 @@
+#ifndef TREE_SAMPLER_H
+#define TREE_SAMPLER_H
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//How `--sample` chooses files while the tree is enumerated.
+enum class SampleMode {
+    Rate, // keep each file independently with probability `rate` (Bernoulli)
+    Count // keep a uniform sample of exactly `count` files (reservoir)
+};
+
+/**
+ * @brief Parsed `--sample=` argument.
+ */
+struct SampleSpec {
+    SampleMode mode = SampleMode::Count;
+    double rate = 1.0;
+    std::uint64_t count = 0;
+};
+
+/**
+ * @brief Parses `0.01` or `1%` as a rate and a plain integer such as `10000` as a count.
+ * @throws std::invalid_argument if the text is neither, or the rate is not in (0, 1].
+ */
+SampleSpec parseSampleSpec(std::string_view text);
+
+/**
+ * @brief Estimate for one FileType, extrapolated from the sample to the whole tree.
+ */
+struct TypeEstimate {
+    std::string fileType; // extractor name, or "UNKNOWN" if the file could not be identified
+    std::uint64_t sampled = 0;
+    double fraction = 0; // estimated share of all files
+    double low = 0;      // 95% confidence interval of `fraction`
+    double high = 0;
+    std::uint64_t sampledBytes = 0;
+    std::array<std::uint64_t, 65> sizeHistogram{}; // sampled files per log2 size bucket; bucket 0 is empty files
+};
+
+/**
+ * @brief Result of `sampleTree`.
+ */
+struct SampleSummary {
+    std::uint64_t population = 0; // regular files seen during enumeration
+    std::uint64_t sampled = 0;
+    std::vector<TypeEstimate> types; // most common first
+};
+
+/**
+ * @brief Enumerates the given trees and runs the full extractors on a random sample of their files.
+ *
+ * Directories are listed with getdents64 and classified by `d_type`, so only sampled files
+ * (and entries on file systems that do not report a type) are ever stat'ed. Symbolic links
+ * are not followed. Sampled files are analyzed concurrently through `analyze_many`.
+ */
+SampleSummary sampleTree(const std::vector<std::filesystem::path>& roots, const SampleSpec& spec);
+
+/**
+ * @brief Prints per-type fractions with confidence intervals and log2 size histograms.
+ */
+void printSampleSummary(std::ostream& out, const SampleSummary& summary);
+
+#endif
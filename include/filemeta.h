@@ -0,0 +1,104 @@
+#ifndef FILEMETA_H
+#define FILEMETA_H
+
+/*
+ * Stable C interface to libfilemeta.
+ *
+ * A session owns everything that is worth keeping between files: read buffers, result
+ * storage, the worker pools used by fma_analyze_many and an optional result cache.
+ * Create one per thread (sessions are not thread-safe) and reuse it for many files.
+ * Results point into session storage and stay valid until the next call on that session.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct fma_session fma_session;
+
+typedef enum fma_status {
+    FMA_OK = 0,
+    FMA_ERROR_INVALID_ARGUMENT,
+    FMA_ERROR_IO,          /* the file could not be opened or read */
+    FMA_ERROR_UNSUPPORTED, /* no extractor recognizes the data */
+    FMA_ERROR_PARSE,       /* an extractor recognized the data but could not parse it */
+    FMA_ERROR_PLUGIN       /* a plugin could not be loaded or lacks its entry point */
+} fma_status;
+
+typedef struct fma_entry {
+    const char* key;
+    const char* value;
+} fma_entry;
+
+typedef struct fma_result {
+    const char* path;       /* as passed in, or the buffer name */
+    const char* file_type;  /* extractor name, e.g. "PNG"; NULL if not identified */
+    const fma_entry* entries;
+    size_t entry_count;
+    fma_status status;
+    const char* error;      /* NULL when status is FMA_OK */
+} fma_result;
+
+/*
+ * Set size to sizeof(fma_session_options) before filling in the rest. Later versions only
+ * append fields and use size to tell which ones the caller knows, so binaries built against
+ * this header keep working.
+ */
+typedef struct fma_session_options {
+    size_t size;               /* sizeof(fma_session_options) as compiled by the caller */
+    unsigned io_threads;       /* fma_analyze_many workers; 0 = one per core */
+    unsigned blocking_threads; /* workers for PDF/ZIP extraction; 0 = 2 */
+    size_t cache_entries;      /* results remembered by path, size and mtime; 0 = no cache */
+} fma_session_options;
+
+/* Called once per file, never concurrently; the result is only valid during the call. */
+typedef void (*fma_result_callback)(const fma_result* result, void* user_data);
+
+/*
+ * options may be NULL for defaults. Returns NULL on allocation failure or if options->size
+ * is smaller than the first version of the struct or larger than this library knows.
+ */
+fma_session* fma_session_create(const fma_session_options* options);
+void fma_session_destroy(fma_session* session);
+
+/*
+ * Message describing why the most recent call on the session failed, or NULL if it
+ * succeeded. Covers calls that publish no fma_result, such as fma_load_plugin and
+ * fma_analyze_many. Valid until the next call on the session.
+ */
+const char* fma_session_last_error(const fma_session* session);
+
+/*
+ * Registers the extractors of a plugin process-wide, for every session; see
+ * ExtractorRegistry::loadPlugin. Safe while other sessions are analyzing: files already
+ * being identified may not see the new extractors yet. Plugins are never unloaded.
+ * Returns FMA_ERROR_PLUGIN with the dlopen/dlsym message in fma_session_last_error on failure.
+ */
+fma_status fma_load_plugin(fma_session* session, const char* plugin_path);
+
+/* Identifies and analyzes one file on the calling thread. */
+fma_status fma_analyze(fma_session* session, const char* path, fma_result* out);
+
+/*
+ * Analyzes data that is already in memory. The format is identified from the data's signature;
+ * name (e.g. "scan.png" or an object key, may be NULL) is only reported back and used for
+ * name-derived fields such as the TXT FileName.
+ */
+fma_status fma_analyze_buffer(fma_session* session, const void* bytes, size_t length, const char* name, fma_result* out);
+
+/*
+ * Analyzes many files on the session's worker pools and reports each one through callback
+ * in completion order. Returns once every file has been reported. Every element of paths
+ * must be non-NULL; per-file failures are reported in the results, not the return value.
+ */
+fma_status fma_analyze_many(fma_session* session, const char* const* paths, size_t count,
+                            fma_result_callback callback, void* user_data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
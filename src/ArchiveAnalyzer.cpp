@@ -0,0 +1,303 @@
+#include "ArchiveAnalyzer.h"
+#include "ExtractorRegistry.h"
+#include "MappedFile.h"
+#include <zip.h>
+#include <algorithm>
+#include <stdexcept>
+#include <span>
+
+namespace {
+
+// Whether `length` bytes starting at `offset` lie inside the archive, without overflowing
+bool fits(std::span<const uint8_t> archive, uint64_t offset, uint64_t length) {
+    return offset <= archive.size() && archive.size() - offset >= length;
+}
+
+/**
+ * @brief Reads the 64-bit values a ZIP64 extended information extra field (id 0x0001) holds
+ * for the central directory fields that are saturated at 0xFFFFFFFF.
+ *
+ * The field stores only the saturated values, in the order uncompressed size, compressed
+ * size, local header offset. Fields the extra field does not cover keep their 32-bit value.
+ */
+void readZIP64Extra(std::span<const uint8_t> extra, uint64_t& uncompressedSize, uint64_t& compressedSize, uint64_t& localHeader) {
+    for (std::size_t field = 0; field + 4 <= extra.size();) {
+        const uint16_t id = readLE16(extra, field);
+        const std::size_t size = readLE16(extra, field + 2);
+        field += 4;
+        if (size > extra.size() - field) {
+            return;
+        }
+        if (id == 0x0001) {
+            std::size_t value = field;
+            for (uint64_t* target : {&uncompressedSize, &compressedSize, &localHeader}) {
+                if (*target == 0xFFFFFFFF && value + 8 <= field + size) {
+                    *target = readLE64(extra, value);
+                    value += 8;
+                }
+            }
+            return;
+        }
+        field += size;
+    }
+}
+
+/**
+ * @brief Locates the data of every stored (method 0) member inside the archive bytes.
+ *
+ * libzip does not expose member offsets, so the central directory is walked here with
+ * strict bounds checks. ZIP64 archives are followed through the ZIP64 end of central
+ * directory record and the members' ZIP64 extra fields. The result is indexed like libzip
+ * (central directory order); entries that are compressed, encrypted or malformed are left
+ * empty and fall back to `zip_fread`.
+ */
+std::vector<std::span<const uint8_t>> locateStoredMembers(std::span<const uint8_t> archive) {
+    std::vector<std::span<const uint8_t>> stored;
+    constexpr std::size_t eocdSize = 22;
+    if (archive.size() < eocdSize) {
+        return stored;
+    }
+
+    // End of central directory record, possibly followed by a comment of up to 64 KiB
+    std::size_t eocd = archive.size() - eocdSize;
+    const std::size_t lowest = eocd > 0xFFFF ? eocd - 0xFFFF : 0;
+    while (readLE32(archive, eocd) != 0x06054b50) {
+        if (eocd == lowest) {
+            return stored;
+        }
+        --eocd;
+    }
+
+    uint64_t entryCount = readLE16(archive, eocd + 10);
+    uint64_t entry = readLE32(archive, eocd + 16);
+
+    // Saturated fields mean the real values are in the ZIP64 record the locator before the EOCD points to
+    constexpr std::size_t zip64LocatorSize = 20;
+    constexpr std::size_t zip64EocdSize = 56;
+    if ((entryCount == 0xFFFF || entry == 0xFFFFFFFF) && eocd >= zip64LocatorSize &&
+        readLE32(archive, eocd - zip64LocatorSize) == 0x07064b50) {
+        const uint64_t zip64Eocd = readLE64(archive, eocd - zip64LocatorSize + 8);
+        if (fits(archive, zip64Eocd, zip64EocdSize) && readLE32(archive, zip64Eocd) == 0x06064b50) {
+            entryCount = readLE64(archive, zip64Eocd + 32);
+            entry = readLE64(archive, zip64Eocd + 48);
+        }
+    }
+
+    // Every entry takes at least a central header, so a larger count is corrupt; don't allocate for it
+    constexpr std::size_t centralHeaderSize = 46;
+    stored.resize(static_cast<std::size_t>(std::min<uint64_t>(entryCount, archive.size() / centralHeaderSize)));
+
+    for (std::size_t i = 0; i < stored.size(); ++i) {
+        if (!fits(archive, entry, centralHeaderSize) || readLE32(archive, entry) != 0x02014b50) {
+            break;
+        }
+
+        const uint16_t flags = readLE16(archive, entry + 8);
+        const uint16_t method = readLE16(archive, entry + 10);
+        uint64_t compressedSize = readLE32(archive, entry + 20);
+        uint64_t uncompressedSize = readLE32(archive, entry + 24);
+        uint64_t localHeader = readLE32(archive, entry + 42);
+        const std::size_t nameLength = readLE16(archive, entry + 28);
+        const std::size_t extraLength = readLE16(archive, entry + 30);
+        const std::size_t extra = entry + centralHeaderSize + nameLength;
+        if (fits(archive, extra, extraLength)) {
+            readZIP64Extra(archive.subspan(extra, extraLength), uncompressedSize, compressedSize, localHeader);
+        }
+        entry += centralHeaderSize + nameLength + extraLength + readLE16(archive, entry + 32);
+
+        const bool encrypted = flags & 0x1;
+        if (method != ZIP_CM_STORE || encrypted || compressedSize != uncompressedSize) {
+            continue;
+        }
+
+        constexpr std::size_t localHeaderSize = 30;
+        if (!fits(archive, localHeader, localHeaderSize) || readLE32(archive, localHeader) != 0x04034b50) {
+            continue;
+        }
+
+        const std::size_t dataOffset = localHeader + localHeaderSize + readLE16(archive, localHeader + 26) + readLE16(archive, localHeader + 28);
+        if (!fits(archive, dataOffset, compressedSize)) {
+            continue;
+        }
+        stored[i] = archive.subspan(dataOffset, compressedSize);
+    }
+
+    return stored;
+}
+
+/**
+ * @brief Gives access to a growing prefix of one archive member.
+ *
+ * Stored members are returned as views into the archive bytes. Compressed members are
+ * inflated on demand, so asking for 8 bytes and then for a header only inflates the header.
+ * If libzip cannot open the member (e.g. it is encrypted or uses an unsupported compression
+ * method), every prefix is empty and `openError` says why.
+ */
+class MemberReader {
+public:
+    MemberReader(zip_t* zip, zip_uint64_t index, std::span<const uint8_t> stored)
+        : zip(zip), index(index), stored(stored) {}
+
+    ~MemberReader() {
+        if (file) {
+            zip_fclose(file);
+        }
+    }
+
+    MemberReader(const MemberReader&) = delete;
+    MemberReader& operator=(const MemberReader&) = delete;
+
+    std::span<const uint8_t> prefix(std::size_t length) {
+        if (stored.data()) {
+            return stored.first(std::min(length, stored.size()));
+        }
+
+        if (!file && !exhausted) {
+            file = zip_fopen_index(zip, index, 0);
+            exhausted = !file;
+            if (!file) {
+                error = zip_error_strerror(zip_get_error(zip));
+            }
+        }
+
+        while (!exhausted && buffer.size() < length) {
+            const std::size_t have = buffer.size();
+            buffer.resize(length);
+            const zip_int64_t count = zip_fread(file, buffer.data() + have, length - have);
+            buffer.resize(have + static_cast<std::size_t>(std::max<zip_int64_t>(count, 0)));
+            exhausted = count <= 0;
+        }
+
+        return std::span<const uint8_t>(buffer).first(std::min(length, buffer.size()));
+    }
+
+    // Why libzip could not open the member; empty if it opened or was never opened
+    const std::string& openError() const { return error; }
+
+private:
+    zip_t* zip;
+    zip_uint64_t index;
+    std::span<const uint8_t> stored;
+    zip_file_t* file = nullptr;
+    bool exhausted = false;
+    std::string error;
+    std::vector<uint8_t> buffer;
+};
+
+/**
+ * @brief Records what the central directory says about a member.
+ *
+ * Applied last so the member's own size wins over whatever a header parser derived
+ * from a truncated buffer.
+ */
+void describeMember(CustomMap<std::string, std::string>& metadata, const zip_stat_t& entryStat, std::uint64_t compressedSize) {
+    metadata["FileName"] = entryStat.name;
+    metadata["FileSize"] = std::to_string(entryStat.size) + " bytes";
+    metadata["CompressedSize"] = std::to_string(compressedSize) + " bytes";
+}
+
+void descendArchive(std::span<const uint8_t> archive, const std::string& prefix, unsigned depth,
+                    const ArchiveOptions& options, std::vector<ArchiveMemberRecord>& records) {
+    zip_error_t error;
+    zip_error_init(&error);
+    zip_source_t* source = zip_source_buffer_create(archive.data(), archive.size(), 0, &error);
+    zip_t* zip = source ? zip_open_from_source(source, ZIP_RDONLY, &error) : nullptr;
+    zip_error_fini(&error);
+    if (!zip) {
+        if (source) {
+            zip_source_free(source);
+        }
+        return;
+    }
+
+    const std::vector<std::span<const uint8_t>> stored = locateStoredMembers(archive);
+    const zip_int64_t entryCount = zip_get_num_entries(zip, 0);
+
+    for (zip_int64_t i = 0; i < entryCount; ++i) {
+        zip_stat_t entryStat;
+        if (zip_stat_index(zip, i, 0, &entryStat) != 0 || !(entryStat.valid & ZIP_STAT_NAME) || !(entryStat.valid & ZIP_STAT_SIZE)) {
+            continue;
+        }
+
+        const std::string name = entryStat.name;
+        if (name.empty() || name.back() == '/') {
+            continue; // directory entry
+        }
+
+        ArchiveMemberRecord record;
+        record.path = prefix + "/" + name;
+        CustomMap<std::string, std::string>& metadata = record.metadata;
+        const std::uint64_t compressedSize = (entryStat.valid & ZIP_STAT_COMP_SIZE) ? entryStat.comp_size : entryStat.size;
+
+        // Zip bomb guard: refuse members that claim to inflate far beyond their stored size
+        if (entryStat.size > 0 && (compressedSize == 0 || static_cast<double>(entryStat.size) / compressedSize > options.maxCompressionRatio)) {
+            describeMember(metadata, entryStat, compressedSize);
+            metadata["Skipped"] = "compression ratio exceeds limit";
+            records.push_back(std::move(record));
+            continue;
+        }
+
+        const std::span<const uint8_t> storedBytes = static_cast<std::size_t>(i) < stored.size() ? stored[i] : std::span<const uint8_t>{};
+        MemberReader reader(zip, i, storedBytes);
+
+        const ExtractorRegistry& registry = ExtractorRegistry::instance();
+        const std::span<const uint8_t> leadingBytes = reader.prefix(ExtractorRegistry::sniffSize);
+        // No bytes to sniff; an empty prefix would otherwise be taken for an empty TXT file
+        if (!reader.openError().empty()) {
+            describeMember(metadata, entryStat, compressedSize);
+            metadata["Skipped"] = "cannot open member: " + reader.openError();
+            records.push_back(std::move(record));
+            continue;
+        }
+        const ExtractorDescriptor* extractor = registry.sniff(leadingBytes);
+        const std::uint64_t wanted = extractor ? std::min<std::uint64_t>(entryStat.size, extractor->readSize) : 0;
+        if (wanted > options.maxMemberBytes) {
+            describeMember(metadata, entryStat, compressedSize);
+            metadata["Skipped"] = "member too large to analyze in memory";
+            records.push_back(std::move(record));
+            continue;
+        }
+
+        const std::span<const uint8_t> bytes = reader.prefix(static_cast<std::size_t>(wanted));
+        try {
+            if (!extractor) {
+                throw std::runtime_error("Unsupported file format.");
+            }
+            metadata = extractor->parse(bytes, name);
+        } catch (const std::exception& e) {
+            metadata["Error"] = e.what();
+        }
+
+        describeMember(metadata, entryStat, compressedSize);
+        metadata["ZeroCopy"] = storedBytes.data() ? "yes" : "no";
+        records.push_back(std::move(record));
+
+        if (extractor && extractor->type == FileType::ZIP) {
+            if (depth + 1 > options.maxDepth) {
+                records.back().metadata["Skipped"] = "archive nesting depth limit reached";
+            } else {
+                const std::string nestedPrefix = records.back().path;
+                descendArchive(bytes, nestedPrefix, depth + 1, options, records);
+            }
+        }
+    }
+
+    zip_close(zip);
+}
+
+} // namespace
+
+std::vector<ArchiveMemberRecord> analyzeArchiveMembers(const std::filesystem::path& archivePath, const ArchiveOptions& options) {
+    // Members are visited in central directory order and only their headers are touched
+    MappedFile mapping(archivePath, MADV_RANDOM);
+    if (mapping.bytes().empty()) {
+        return {};
+    }
+    return analyzeArchiveMembers(mapping.bytes(), archivePath.string(), options);
+}
+
+std::vector<ArchiveMemberRecord> analyzeArchiveMembers(std::span<const uint8_t> archive, const std::string& name, const ArchiveOptions& options) {
+    std::vector<ArchiveMemberRecord> records;
+    descendArchive(archive, name, 0, options, records);
+    return records;
+}
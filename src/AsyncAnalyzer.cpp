@@ -0,0 +1,194 @@
+#include "AsyncAnalyzer.h"
+#include "ExtractorRegistry.h"
+#include <algorithm>
+
+namespace {
+
+/**
+ * @brief Results of detached tasks, handed to a single coroutine waiting in `pop`.
+ *
+ * The waiting coroutine is resumed on `executor`, never on the thread that pushed, so a
+ * slow consumer cannot stall a producer's pool (e.g. the small blocking pool).
+ */
+template <typename T>
+class CompletionQueue : public std::enable_shared_from_this<CompletionQueue<T>> {
+public:
+    explicit CompletionQueue(Executor& executor) : executor(executor) {}
+
+    void push(T value) {
+        bool wake = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            items.push_back(std::move(value));
+            wake = waiter && !wakePending;
+            wakePending = wakePending || wake;
+        }
+        if (wake) {
+            executor.post([queue = this->shared_from_this()] { queue->resumeWaiter(); });
+        }
+    }
+
+    struct PopAwaiter {
+        CompletionQueue& queue;
+        std::coroutine_handle<> suspended;
+
+        PopAwaiter(CompletionQueue& queue) : queue(queue) {}
+        PopAwaiter(const PopAwaiter&) = delete;
+        PopAwaiter& operator=(const PopAwaiter&) = delete;
+
+        // Runs with the awaiting frame if it is destroyed while suspended; a later push must not resume it
+        ~PopAwaiter() {
+            if (suspended) {
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                if (queue.waiter == suspended) {
+                    queue.waiter = {};
+                }
+            }
+        }
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> handle) {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (!queue.items.empty()) {
+                return false;
+            }
+            queue.waiter = suspended = handle;
+            return true;
+        }
+        T await_resume() {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            suspended = {};
+            T value = std::move(queue.items.front());
+            queue.items.pop_front();
+            return value;
+        }
+    };
+
+    PopAwaiter pop() { return PopAwaiter(*this); }
+
+private:
+    // Takes the waiter under the lock, so one that was withdrawn meanwhile is never resumed
+    void resumeWaiter() {
+        std::coroutine_handle<> handle;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            handle = std::exchange(waiter, {});
+            wakePending = false;
+        }
+        if (handle) {
+            handle.resume();
+        }
+    }
+
+    Executor& executor;
+    std::mutex mutex;
+    std::deque<T> items;
+    std::coroutine_handle<> waiter;
+    bool wakePending = false; // a resumeWaiter call is posted and has not run yet
+};
+
+detached_task deliver(task<MetadataRecord> work, std::shared_ptr<CompletionQueue<MetadataRecord>> queue) {
+    queue->push(co_await std::move(work));
+}
+
+} // namespace
+
+ThreadPool::ThreadPool(std::size_t threadCount) {
+    threadCount = std::max<std::size_t>(threadCount, 1);
+    threads.reserve(threadCount);
+    for (std::size_t i = 0; i < threadCount; ++i) {
+        threads.emplace_back([this] { run(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    ready.notify_all();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+void ThreadPool::post(std::function<void()> work) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(std::move(work));
+    }
+    ready.notify_one();
+}
+
+void ThreadPool::run() {
+    for (;;) {
+        std::function<void()> work;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            ready.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty()) {
+                return;
+            }
+            work = std::move(queue.front());
+            queue.pop_front();
+        }
+        work();
+    }
+}
+
+AsyncContext defaultAsyncContext() {
+    // Never destroyed: detached work may still be running during static destruction
+    static ThreadPool* io = new ThreadPool(std::max(1u, std::thread::hardware_concurrency()));
+    static ThreadPool* blocking = new ThreadPool(2);
+    return {io, blocking};
+}
+
+task<MetadataRecord> analyze_async(std::filesystem::path path, AsyncContext context) {
+    // Never do file I/O on the caller's thread
+    co_await ScheduleOn{*context.io};
+
+    MetadataRecord record{path, {}, {}, {}};
+    try {
+        const ExtractorRegistry& registry = ExtractorRegistry::instance();
+        std::vector<uint8_t> bytes;
+        const std::size_t prefetched = registry.prefetchSize();
+        if (!readFilePrefix(path, prefetched, bytes)) {
+            record.status = AnalysisStatus::ReadFailed;
+            record.error = "Cannot open " + path.string();
+            co_return record;
+        }
+        const ExtractorDescriptor* extractor = registry.sniff(bytes);
+        if (!extractor) {
+            record.status = AnalysisStatus::Unsupported;
+            record.error = unsupportedFormatMessage;
+            co_return record;
+        }
+        record.fileType = extractor->name;
+
+        // Whole-file extractors can block for a long time; keep them off the I/O threads
+        if (extractor->cost != CostClass::Header) {
+            co_await ScheduleOn{*context.blocking};
+        }
+        record.metadata = registry.extract(*extractor, path, bytes, prefetched);
+    } catch (const std::exception& e) {
+        record.status = record.fileType.empty() ? AnalysisStatus::ReadFailed : AnalysisStatus::ParseFailed;
+        record.error = e.what();
+    }
+    co_return record;
+}
+
+async_generator<MetadataRecord> analyze_many(std::vector<std::filesystem::path> paths, AsyncContext context, std::size_t maxInFlight) {
+    auto queue = std::make_shared<CompletionQueue<MetadataRecord>>(*context.io);
+    maxInFlight = std::max<std::size_t>(maxInFlight, 1);
+
+    std::size_t next = 0;
+    std::size_t inFlight = 0;
+    while (next < paths.size() || inFlight > 0) {
+        for (; inFlight < maxInFlight && next < paths.size(); ++inFlight) {
+            deliver(analyze_async(std::move(paths[next++]), context), queue);
+        }
+        MetadataRecord record = co_await queue->pop();
+        --inFlight;
+        co_yield std::move(record);
+    }
+}
@@ -0,0 +1,499 @@
+#include "ColumnarIndex.h"
+#include "ExtractorRegistry.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <ctime>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+constexpr char indexMagic[8] = {'F', 'M', 'A', 'I', 'D', 'X', '1', '\0'};
+constexpr std::size_t dictionaryEntrySize = 16;   // NUL-terminated type name
+constexpr std::size_t maxDictionaryEntries = 64;  // one bit each in ZoneMap::typeMask
+constexpr std::size_t sectionAlignment = 64;
+
+/**
+ * @brief On-disk header of an index file. All offsets are from the start of the file.
+ */
+struct IndexFileHeader {
+    char     magic[8];
+    uint64_t rowCount;
+    uint64_t zoneRows;
+    uint64_t dictionaryCount;
+    uint64_t dictionaryOffset;
+    uint64_t typeCodeOffset;
+    uint64_t widthOffset;
+    uint64_t heightOffset;
+    uint64_t sizeOffset;
+    uint64_t mtimeOffset;
+    uint64_t zoneOffset;
+    uint64_t pathOffsetsOffset; // rowCount + 1 entries into the path blob
+    uint64_t pathBlobOffset;
+    uint64_t fileLength;
+};
+
+uint64_t alignSection(uint64_t offset) {
+    return (offset + sectionAlignment - 1) / sectionAlignment * sectionAlignment;
+}
+
+uint32_t parseDimension(const CustomMap<std::string, std::string>& metadata, const std::string& key) {
+    auto it = metadata.find(key);
+    if (it == metadata.end()) {
+        return 0;
+    }
+
+    int64_t value = 0;
+    std::from_chars(it->value.data(), it->value.data() + it->value.size(), value);
+    value = value < 0 ? -value : value; // bottom-up BMPs report a negative height
+    return static_cast<uint32_t>(std::min<int64_t>(value, UINT32_MAX));
+}
+
+IndexRow makeIndexRow(const std::filesystem::path& filePath) {
+    IndexRow row;
+    row.path = filePath.string();
+
+    struct stat fileStat;
+    if (stat(filePath.c_str(), &fileStat) == 0) {
+        row.size = static_cast<uint64_t>(fileStat.st_size);
+        row.mtime = static_cast<int64_t>(fileStat.st_mtime);
+    }
+
+    // One read serves both identification and the header parse
+    const ExtractorRegistry& registry = ExtractorRegistry::instance();
+    std::vector<uint8_t> bytes;
+    const std::size_t prefetched = registry.prefetchSize();
+    if (!readFilePrefix(filePath, prefetched, bytes)) {
+        return row;
+    }
+    const ExtractorDescriptor* extractor = registry.sniff(bytes);
+    if (!extractor) {
+        return row;
+    }
+    row.fileType = extractor->name;
+
+    // Only bounded extractors can report dimensions cheaply; skip documents and archives
+    if (extractor->cost == CostClass::Header) {
+        try {
+            CustomMap<std::string, std::string> metadata = registry.extract(*extractor, filePath, bytes, prefetched);
+            row.width = parseDimension(metadata, "Width");
+            row.height = parseDimension(metadata, "Height");
+        } catch (const std::exception&) {
+            // Malformed header: keep the row without dimensions
+        }
+    }
+
+    return row;
+}
+
+template <typename V>
+bool rangeMayMatch(V minimum, V maximum, CompareOp op, int64_t value) {
+    const int64_t low = static_cast<int64_t>(minimum);
+    const int64_t high = static_cast<int64_t>(maximum);
+    switch (op) {
+        case CompareOp::Less:         return low < value;
+        case CompareOp::LessEqual:    return low <= value;
+        case CompareOp::Greater:      return high > value;
+        case CompareOp::GreaterEqual: return high >= value;
+        case CompareOp::Equal:        return low <= value && value <= high;
+        case CompareOp::NotEqual:     return !(low == value && high == value);
+    }
+    return true;
+}
+
+bool zoneMayMatch(const ZoneMap& zone, const QueryPredicate& predicate) {
+    switch (predicate.column) {
+        case IndexColumn::Type: {
+            const uint64_t bit = uint64_t{1} << predicate.value;
+            return predicate.op == CompareOp::Equal ? (zone.typeMask & bit) != 0 : (zone.typeMask & ~bit) != 0;
+        }
+        case IndexColumn::Width:  return rangeMayMatch(zone.minWidth, zone.maxWidth, predicate.op, predicate.value);
+        case IndexColumn::Height: return rangeMayMatch(zone.minHeight, zone.maxHeight, predicate.op, predicate.value);
+        case IndexColumn::Size:   return rangeMayMatch(zone.minSize, zone.maxSize, predicate.op, predicate.value);
+        case IndexColumn::Mtime:  return rangeMayMatch(zone.minMtime, zone.maxMtime, predicate.op, predicate.value);
+    }
+    return true;
+}
+
+// Branch-free and in the column's own type so the compiler can vectorize the loop
+template <typename V, typename Compare>
+void applyFilter(const V* __restrict column, std::size_t count, uint8_t* __restrict selection, Compare compare) {
+    for (std::size_t i = 0; i < count; ++i) {
+        selection[i] &= static_cast<uint8_t>(compare(column[i]));
+    }
+}
+
+template <typename V>
+void filterColumn(const V* column, std::size_t count, CompareOp op, int64_t value, uint8_t* selection) {
+    // A value outside the column's range makes the predicate constant for every row
+    constexpr int64_t lowest = static_cast<int64_t>(std::numeric_limits<V>::min());
+    constexpr int64_t highest = std::numeric_limits<V>::max() > static_cast<uint64_t>(INT64_MAX) ? INT64_MAX : static_cast<int64_t>(std::numeric_limits<V>::max());
+    if (value < lowest || value > highest) {
+        const bool below = value < lowest;
+        const bool result = (op == CompareOp::NotEqual) ||
+                            (below ? (op == CompareOp::Greater || op == CompareOp::GreaterEqual)
+                                   : (op == CompareOp::Less || op == CompareOp::LessEqual));
+        if (!result) {
+            std::fill_n(selection, count, uint8_t{0});
+        }
+        return;
+    }
+
+    const V bound = static_cast<V>(value);
+    switch (op) {
+        case CompareOp::Less:         applyFilter(column, count, selection, [bound](V v) { return v < bound; }); break;
+        case CompareOp::LessEqual:    applyFilter(column, count, selection, [bound](V v) { return v <= bound; }); break;
+        case CompareOp::Greater:      applyFilter(column, count, selection, [bound](V v) { return v > bound; }); break;
+        case CompareOp::GreaterEqual: applyFilter(column, count, selection, [bound](V v) { return v >= bound; }); break;
+        case CompareOp::Equal:        applyFilter(column, count, selection, [bound](V v) { return v == bound; }); break;
+        case CompareOp::NotEqual:     applyFilter(column, count, selection, [bound](V v) { return v != bound; }); break;
+    }
+}
+
+template <typename T>
+void writeSection(std::ofstream& out, uint64_t offset, const T* values, std::size_t count) {
+    out.seekp(static_cast<std::streamoff>(offset));
+    out.write(reinterpret_cast<const char*>(values), static_cast<std::streamsize>(count * sizeof(T)));
+}
+
+} // namespace
+
+QueryPredicate parsePredicate(std::string_view text) {
+    const std::size_t opStart = text.find_first_of("<>=!");
+    if (opStart == std::string_view::npos || opStart == 0) {
+        throw std::invalid_argument("Invalid predicate: " + std::string(text));
+    }
+
+    QueryPredicate predicate;
+    std::string column(text.substr(0, opStart));
+    std::transform(column.begin(), column.end(), column.begin(), [](unsigned char c) { return std::tolower(c); });
+    if (column == "type") predicate.column = IndexColumn::Type;
+    else if (column == "width") predicate.column = IndexColumn::Width;
+    else if (column == "height") predicate.column = IndexColumn::Height;
+    else if (column == "size") predicate.column = IndexColumn::Size;
+    else if (column == "mtime") predicate.column = IndexColumn::Mtime;
+    else throw std::invalid_argument("Unknown column: " + column);
+
+    std::string_view rest = text.substr(opStart);
+    if (rest.starts_with("<=")) predicate.op = CompareOp::LessEqual;
+    else if (rest.starts_with(">=")) predicate.op = CompareOp::GreaterEqual;
+    else if (rest.starts_with("!=")) predicate.op = CompareOp::NotEqual;
+    else if (rest.starts_with("<")) predicate.op = CompareOp::Less;
+    else if (rest.starts_with(">")) predicate.op = CompareOp::Greater;
+    else if (rest.starts_with("=")) predicate.op = CompareOp::Equal;
+    else throw std::invalid_argument("Invalid operator in predicate: " + std::string(text));
+
+    const bool twoCharOp = predicate.op == CompareOp::LessEqual || predicate.op == CompareOp::GreaterEqual || predicate.op == CompareOp::NotEqual;
+    std::string_view value = rest.substr(twoCharOp ? 2 : 1);
+    if (value.empty()) {
+        throw std::invalid_argument("Missing value in predicate: " + std::string(text));
+    }
+
+    if (predicate.column == IndexColumn::Type) {
+        if (predicate.op != CompareOp::Equal && predicate.op != CompareOp::NotEqual) {
+            throw std::invalid_argument("type only supports = and !=");
+        }
+        predicate.typeName = std::string(value);
+        std::transform(predicate.typeName.begin(), predicate.typeName.end(), predicate.typeName.begin(), [](unsigned char c) { return std::toupper(c); });
+        return predicate;
+    }
+
+    int64_t number = 0;
+    auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), number);
+    if (ec != std::errc()) {
+        throw std::invalid_argument("Invalid number in predicate: " + std::string(text));
+    }
+    std::string_view suffix(end, value.data() + value.size() - end);
+
+    // number * factor, rejecting values that do not fit instead of overflowing
+    auto scaled = [&](int64_t factor) {
+        if (number > std::numeric_limits<int64_t>::max() / factor || number < std::numeric_limits<int64_t>::min() / factor) {
+            throw std::invalid_argument("Value out of range in predicate: " + std::string(text));
+        }
+        return number * factor;
+    };
+
+    if (predicate.column == IndexColumn::Mtime && number < 0 && !suffix.empty()) {
+        // Relative time: -7d is seven days ago
+        const int64_t unit = suffix == "d" ? 86400 : suffix == "h" ? 3600 : suffix == "m" ? 60 : 0;
+        if (unit == 0) {
+            throw std::invalid_argument("Invalid time unit in predicate: " + std::string(text));
+        }
+        predicate.value = static_cast<int64_t>(std::time(nullptr)) + scaled(unit);
+    } else {
+        const int64_t multiplier = suffix.empty() ? 1 : suffix == "K" ? 1ll << 10 : suffix == "M" ? 1ll << 20 : suffix == "G" ? 1ll << 30 : 0;
+        if (multiplier == 0) {
+            throw std::invalid_argument("Invalid suffix in predicate: " + std::string(text));
+        }
+        predicate.value = scaled(multiplier);
+    }
+    return predicate;
+}
+
+std::vector<IndexRow> collectIndexRows(const std::vector<std::filesystem::path>& roots) {
+    std::vector<IndexRow> rows;
+    for (const auto& root : roots) {
+        std::error_code ec;
+        if (std::filesystem::is_directory(root, ec)) {
+            for (auto it = std::filesystem::recursive_directory_iterator(root, std::filesystem::directory_options::skip_permission_denied, ec);
+                 !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+                if (it->is_regular_file(ec)) {
+                    rows.push_back(makeIndexRow(it->path()));
+                }
+            }
+        } else if (std::filesystem::is_regular_file(root, ec)) {
+            rows.push_back(makeIndexRow(root));
+        }
+    }
+    return rows;
+}
+
+void writeIndex(const std::filesystem::path& indexPath, const std::vector<IndexRow>& rows) {
+    const std::size_t rowCount = rows.size();
+
+    // Dictionary encode the file type column in order of first appearance
+    std::vector<std::string> dictionary;
+    std::vector<uint8_t> typeCodes(rowCount);
+    for (std::size_t i = 0; i < rowCount; ++i) {
+        auto it = std::find(dictionary.begin(), dictionary.end(), rows[i].fileType);
+        if (it == dictionary.end()) {
+            // A truncated name could never match a type= predicate, and codes past the mask would wrap
+            if (rows[i].fileType.size() >= dictionaryEntrySize) {
+                throw std::runtime_error("File type name too long for the index (at most " + std::to_string(dictionaryEntrySize - 1) +
+                                         " characters): " + rows[i].fileType);
+            }
+            if (dictionary.size() == maxDictionaryEntries) {
+                throw std::runtime_error("Too many distinct file types for the index (at most " + std::to_string(maxDictionaryEntries) + ")");
+            }
+            it = dictionary.insert(dictionary.end(), rows[i].fileType);
+        }
+        typeCodes[i] = static_cast<uint8_t>(it - dictionary.begin());
+    }
+
+    std::vector<char> dictionaryBytes(dictionary.size() * dictionaryEntrySize, '\0');
+    for (std::size_t i = 0; i < dictionary.size(); ++i) {
+        std::copy(dictionary[i].begin(), dictionary[i].end(), &dictionaryBytes[i * dictionaryEntrySize]);
+    }
+
+    std::vector<uint32_t> widths(rowCount), heights(rowCount);
+    std::vector<uint64_t> sizes(rowCount), pathOffsets;
+    std::vector<int64_t> mtimes(rowCount);
+    std::string pathBlob;
+    for (std::size_t i = 0; i < rowCount; ++i) {
+        widths[i] = rows[i].width;
+        heights[i] = rows[i].height;
+        sizes[i] = rows[i].size;
+        mtimes[i] = rows[i].mtime;
+        pathOffsets.push_back(pathBlob.size());
+        pathBlob += rows[i].path;
+    }
+    pathOffsets.push_back(pathBlob.size());
+
+    const std::size_t zoneCount = (rowCount + ColumnarIndex::zoneRows - 1) / ColumnarIndex::zoneRows;
+    std::vector<ZoneMap> zones(zoneCount);
+    for (std::size_t z = 0; z < zoneCount; ++z) {
+        const std::size_t begin = z * ColumnarIndex::zoneRows;
+        const std::size_t end = std::min(rowCount, begin + ColumnarIndex::zoneRows);
+        ZoneMap& zone = zones[z];
+        zone = {widths[begin], widths[begin], heights[begin], heights[begin], sizes[begin], sizes[begin], mtimes[begin], mtimes[begin], 0};
+        for (std::size_t i = begin; i < end; ++i) {
+            zone.minWidth = std::min(zone.minWidth, widths[i]);
+            zone.maxWidth = std::max(zone.maxWidth, widths[i]);
+            zone.minHeight = std::min(zone.minHeight, heights[i]);
+            zone.maxHeight = std::max(zone.maxHeight, heights[i]);
+            zone.minSize = std::min(zone.minSize, sizes[i]);
+            zone.maxSize = std::max(zone.maxSize, sizes[i]);
+            zone.minMtime = std::min(zone.minMtime, mtimes[i]);
+            zone.maxMtime = std::max(zone.maxMtime, mtimes[i]);
+            zone.typeMask |= uint64_t{1} << typeCodes[i];
+        }
+    }
+
+    IndexFileHeader header{};
+    std::copy_n(indexMagic, sizeof(indexMagic), header.magic);
+    header.rowCount = rowCount;
+    header.zoneRows = ColumnarIndex::zoneRows;
+    header.dictionaryCount = dictionary.size();
+    header.dictionaryOffset = alignSection(sizeof(IndexFileHeader));
+    header.typeCodeOffset = alignSection(header.dictionaryOffset + dictionaryBytes.size());
+    header.widthOffset = alignSection(header.typeCodeOffset + rowCount * sizeof(uint8_t));
+    header.heightOffset = alignSection(header.widthOffset + rowCount * sizeof(uint32_t));
+    header.sizeOffset = alignSection(header.heightOffset + rowCount * sizeof(uint32_t));
+    header.mtimeOffset = alignSection(header.sizeOffset + rowCount * sizeof(uint64_t));
+    header.zoneOffset = alignSection(header.mtimeOffset + rowCount * sizeof(int64_t));
+    header.pathOffsetsOffset = alignSection(header.zoneOffset + zoneCount * sizeof(ZoneMap));
+    header.pathBlobOffset = alignSection(header.pathOffsetsOffset + (rowCount + 1) * sizeof(uint64_t));
+    header.fileLength = header.pathBlobOffset + pathBlob.size();
+
+    std::ofstream out(indexPath, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        throw std::runtime_error("Cannot write index file: " + indexPath.string());
+    }
+
+    writeSection(out, 0, &header, 1);
+    writeSection(out, header.dictionaryOffset, dictionaryBytes.data(), dictionaryBytes.size());
+    writeSection(out, header.typeCodeOffset, typeCodes.data(), rowCount);
+    writeSection(out, header.widthOffset, widths.data(), rowCount);
+    writeSection(out, header.heightOffset, heights.data(), rowCount);
+    writeSection(out, header.sizeOffset, sizes.data(), rowCount);
+    writeSection(out, header.mtimeOffset, mtimes.data(), rowCount);
+    writeSection(out, header.zoneOffset, zones.data(), zoneCount);
+    writeSection(out, header.pathOffsetsOffset, pathOffsets.data(), rowCount + 1);
+    writeSection(out, header.pathBlobOffset, pathBlob.data(), pathBlob.size());
+
+    if (!out) {
+        throw std::runtime_error("Failed writing index file: " + indexPath.string());
+    }
+}
+
+ColumnarIndex::ColumnarIndex(const std::filesystem::path& indexPath) {
+    int fd = ::open(indexPath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open index file: " + indexPath.string());
+    }
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) == 0 && static_cast<std::size_t>(fileStat.st_size) >= sizeof(IndexFileHeader)) {
+        void* mapping = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED) {
+            data = static_cast<const uint8_t*>(mapping);
+            length = static_cast<std::size_t>(fileStat.st_size);
+        }
+    }
+    ::close(fd);
+
+    IndexFileHeader header{};
+    if (data) {
+        std::copy_n(data, sizeof(IndexFileHeader), reinterpret_cast<uint8_t*>(&header));
+    }
+
+    const uint64_t rowCount = header.rowCount;
+    const uint64_t zoneCount = (rowCount + zoneRows - 1) / zoneRows;
+    auto fits = [&](uint64_t offset, uint64_t bytes) {
+        return offset % sectionAlignment == 0 && offset <= length && bytes <= length - offset;
+    };
+    const bool valid = data && std::equal(std::begin(indexMagic), std::end(indexMagic), header.magic) &&
+                       header.zoneRows == zoneRows && rowCount <= UINT32_MAX && header.dictionaryCount <= maxDictionaryEntries &&
+                       header.fileLength == length &&
+                       fits(header.dictionaryOffset, header.dictionaryCount * dictionaryEntrySize) &&
+                       fits(header.typeCodeOffset, rowCount) &&
+                       fits(header.widthOffset, rowCount * sizeof(uint32_t)) &&
+                       fits(header.heightOffset, rowCount * sizeof(uint32_t)) &&
+                       fits(header.sizeOffset, rowCount * sizeof(uint64_t)) &&
+                       fits(header.mtimeOffset, rowCount * sizeof(int64_t)) &&
+                       fits(header.zoneOffset, zoneCount * sizeof(ZoneMap)) &&
+                       fits(header.pathOffsetsOffset, (rowCount + 1) * sizeof(uint64_t)) &&
+                       header.pathBlobOffset <= length;
+    if (!valid) {
+        unmap();
+        throw std::runtime_error("Invalid index file: " + indexPath.string());
+    }
+
+    rows = static_cast<std::size_t>(rowCount);
+    for (uint64_t i = 0; i < header.dictionaryCount; ++i) {
+        const char* entry = reinterpret_cast<const char*>(data + header.dictionaryOffset + i * dictionaryEntrySize);
+        dictionary.emplace_back(entry, std::find(entry, entry + dictionaryEntrySize, '\0') - entry);
+    }
+    typeCodes = data + header.typeCodeOffset;
+    widths = reinterpret_cast<const uint32_t*>(data + header.widthOffset);
+    heights = reinterpret_cast<const uint32_t*>(data + header.heightOffset);
+    sizes = reinterpret_cast<const uint64_t*>(data + header.sizeOffset);
+    mtimes = reinterpret_cast<const int64_t*>(data + header.mtimeOffset);
+    zones = reinterpret_cast<const ZoneMap*>(data + header.zoneOffset);
+    pathOffsets = reinterpret_cast<const uint64_t*>(data + header.pathOffsetsOffset);
+    pathBlob = reinterpret_cast<const char*>(data + header.pathBlobOffset);
+
+    // Codes and path offsets are trusted by the scan loops, so check them once here
+    const uint64_t blobLength = length - header.pathBlobOffset;
+    const bool codesValid = std::all_of(typeCodes, typeCodes + rows, [&](uint8_t code) { return code < dictionary.size(); });
+    bool offsetsValid = pathOffsets[0] == 0 && pathOffsets[rows] <= blobLength;
+    for (std::size_t i = 0; offsetsValid && i < rows; ++i) {
+        offsetsValid = pathOffsets[i] <= pathOffsets[i + 1];
+    }
+    if (!codesValid || !offsetsValid) {
+        unmap();
+        throw std::runtime_error("Corrupt index file: " + indexPath.string());
+    }
+}
+
+ColumnarIndex::~ColumnarIndex() {
+    unmap();
+}
+
+void ColumnarIndex::unmap() {
+    if (data) {
+        munmap(const_cast<uint8_t*>(data), length);
+        data = nullptr;
+    }
+}
+
+std::string_view ColumnarIndex::path(std::size_t row) const {
+    return std::string_view(pathBlob + pathOffsets[row], pathOffsets[row + 1] - pathOffsets[row]);
+}
+
+std::string_view ColumnarIndex::typeName(std::size_t row) const {
+    return dictionary[typeCodes[row]];
+}
+
+std::vector<uint32_t> ColumnarIndex::query(const std::vector<QueryPredicate>& predicates) const {
+    std::vector<uint32_t> matches;
+
+    // Resolve type names to dictionary codes; a type that never occurs decides the predicate up front
+    std::vector<QueryPredicate> resolved;
+    for (const auto& predicate : predicates) {
+        if (predicate.column != IndexColumn::Type) {
+            resolved.push_back(predicate);
+            continue;
+        }
+
+        auto it = std::find(dictionary.begin(), dictionary.end(), predicate.typeName);
+        if (it == dictionary.end()) {
+            if (predicate.op == CompareOp::Equal) {
+                return matches;
+            }
+            continue; // != an absent type is always true
+        }
+        QueryPredicate code = predicate;
+        code.value = it - dictionary.begin();
+        resolved.push_back(code);
+    }
+
+    std::vector<uint8_t> selection(zoneRows);
+    const std::size_t zoneCount = (rows + zoneRows - 1) / zoneRows;
+    for (std::size_t z = 0; z < zoneCount; ++z) {
+        const bool mayMatch = std::all_of(resolved.begin(), resolved.end(), [&](const QueryPredicate& predicate) {
+            return zoneMayMatch(zones[z], predicate);
+        });
+        if (!mayMatch) {
+            continue;
+        }
+
+        const std::size_t begin = z * zoneRows;
+        const std::size_t count = std::min(zoneRows, rows - begin);
+        std::fill_n(selection.begin(), count, uint8_t{1});
+
+        for (const auto& predicate : resolved) {
+            switch (predicate.column) {
+                case IndexColumn::Type:   filterColumn(typeCodes + begin, count, predicate.op, predicate.value, selection.data()); break;
+                case IndexColumn::Width:  filterColumn(widths + begin, count, predicate.op, predicate.value, selection.data()); break;
+                case IndexColumn::Height: filterColumn(heights + begin, count, predicate.op, predicate.value, selection.data()); break;
+                case IndexColumn::Size:   filterColumn(sizes + begin, count, predicate.op, predicate.value, selection.data()); break;
+                case IndexColumn::Mtime:  filterColumn(mtimes + begin, count, predicate.op, predicate.value, selection.data()); break;
+            }
+        }
+
+        for (std::size_t i = 0; i < count; ++i) {
+            if (selection[i]) {
+                matches.push_back(static_cast<uint32_t>(begin + i));
+            }
+        }
+    }
+
+    return matches;
+}
@@ -0,0 +1,139 @@
+#include "ExtractorRegistry.h"
+#include "MappedFile.h"
+#include <dlfcn.h>
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+// Largest single up-front read; extractors needing more read on from its end when they match
+constexpr std::size_t maxPrefetchSize = 16 * 1024;
+
+} // namespace
+
+ExtractorRegistry::ExtractorRegistry() {
+    for (const ExtractorDescriptor& descriptor : builtinExtractors()) {
+        add(descriptor);
+    }
+}
+
+ExtractorRegistry& ExtractorRegistry::instance() {
+    static ExtractorRegistry registry;
+    return registry;
+}
+
+int ExtractorRegistry::add(const ExtractorDescriptor& descriptor) {
+    std::lock_guard<std::mutex> lock(registration);
+    const std::size_t id = count.load(std::memory_order_relaxed);
+    if (id == maxExtractors || !descriptor.name || !descriptor.parse) {
+        return -1;
+    }
+
+    // The slot is not visible to lookups until count is published below
+    extractors[id] = descriptor;
+    if (descriptor.readSize <= maxPrefetchSize) {
+        prefetch.store(std::max(prefetch.load(std::memory_order_relaxed), descriptor.readSize), std::memory_order_relaxed);
+    }
+    count.store(id + 1, std::memory_order_release);
+    if (descriptor.type != FileType::UNKNOWN) {
+        byType[static_cast<std::size_t>(descriptor.type)].store(&extractors[id], std::memory_order_release);
+    }
+    return static_cast<int>(id);
+}
+
+void ExtractorRegistry::loadPlugin(const std::filesystem::path& pluginPath) {
+    // Kept loaded for the life of the process since descriptors point into it
+    void* handle = dlopen(pluginPath.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!handle) {
+        throw std::runtime_error("Cannot load plugin " + pluginPath.string() + ": " + dlerror());
+    }
+
+    auto entryPoint = reinterpret_cast<PluginEntryPoint>(dlsym(handle, pluginEntryPointName));
+    if (!entryPoint) {
+        dlclose(handle);
+        throw std::runtime_error("Plugin " + pluginPath.string() + " does not export " + pluginEntryPointName);
+    }
+    entryPoint(*this);
+}
+
+const ExtractorDescriptor* ExtractorRegistry::forType(FileType type) const {
+    return byType[static_cast<std::size_t>(type)].load(std::memory_order_acquire);
+}
+
+const ExtractorDescriptor* ExtractorRegistry::find(std::string_view name) const {
+    const std::size_t registered = size();
+    for (std::size_t i = 0; i < registered; ++i) {
+        if (name == extractors[i].name) {
+            return &extractors[i];
+        }
+    }
+    return nullptr;
+}
+
+const ExtractorDescriptor* ExtractorRegistry::sniff(std::span<const uint8_t> leadingBytes) const {
+    leadingBytes = leadingBytes.first(std::min(leadingBytes.size(), sniffSize));
+
+    const ExtractorDescriptor* fallback = nullptr;
+    for (std::size_t i = size(); i-- > 0;) {
+        if (!extractors[i].sniff) {
+            fallback = fallback ? fallback : &extractors[i];
+        } else if (extractors[i].sniff(leadingBytes)) {
+            return &extractors[i];
+        }
+    }
+    return fallback;
+}
+
+Extraction ExtractorRegistry::analyze(const std::filesystem::path& filePath, bool withContent) const {
+    std::vector<uint8_t> bytes;
+    const std::size_t prefetched = prefetchSize();
+    if (!readFilePrefix(filePath, prefetched, bytes)) {
+        throw std::runtime_error("Cannot open " + filePath.string());
+    }
+
+    const ExtractorDescriptor* extractor = sniff(bytes);
+    if (!extractor) {
+        throw std::runtime_error("Unsupported file format.");
+    }
+    return {extractor, extract(*extractor, filePath, bytes, prefetched, withContent)};
+}
+
+const ExtractorDescriptor* ExtractorRegistry::identify(const std::filesystem::path& filePath, std::vector<uint8_t>& bytes) const {
+    if (!readFilePrefix(filePath, prefetchSize(), bytes)) {
+        return nullptr;
+    }
+    return sniff(bytes);
+}
+
+CustomMap<std::string, std::string> ExtractorRegistry::extract(const ExtractorDescriptor& extractor, const std::filesystem::path& filePath, std::vector<uint8_t>& bytes,
+                                                                std::size_t prefetched, bool withContent) const {
+    CustomMap<std::string, std::string> metadata;
+    if (extractor.readSize == SIZE_MAX && extractor.parseFile) {
+        metadata = extractor.parseFile(filePath);
+    } else {
+        // A short prefetch means we already have the whole file. Compared against the length
+        // the caller asked for: a plugin loaded since may have raised prefetchSize()
+        if (extractor.readSize > bytes.size() && bytes.size() >= prefetched) {
+            extendFilePrefix(filePath, extractor.readSize, bytes);
+        }
+        metadata = extractor.parse(bytes, filePath);
+    }
+
+    if (withContent && extractor.parseContent) {
+        // Mapped rather than read: decoders touch only the pages they need (e.g. a GIF's first
+        // frame), and multi-gigabyte images are never copied to the heap
+        const MappedFile mapping(filePath, MADV_SEQUENTIAL);
+        for (const auto& [key, value] : extractor.parseContent(mapping.bytes())) {
+            metadata[key] = value;
+        }
+    }
+    return metadata;
+}
+
+Extraction ExtractorRegistry::analyze(std::span<const uint8_t> bytes, const std::filesystem::path& name) const {
+    const ExtractorDescriptor* extractor = sniff(bytes);
+    if (!extractor) {
+        throw std::runtime_error("Unsupported file format.");
+    }
+    return {extractor, extractor->parse(bytes, name)};
+}
@@ -1,4 +1,6 @@
 #include "FileMetaDataAnalyzer.h"
+#include "ExtractorRegistry.h"
+#include "PerceptualHash.h"
 #include <poppler/cpp/poppler-document.h>
 #include <poppler/cpp/poppler-page.h>
 #include <type_traits>
@@ -9,9 +11,14 @@
 #include <zip.h>
 #include <type_traits>
 #include <sys/stat.h>
+#include <endian.h>
 #include <string>
 #include <ctime>
 #include <cassert>
+#include <cstdio>
+#include <vector>
+#include <algorithm>
+#include <climits>
 
 BasicMetadata extractBasicMetadata(const std::filesystem::path& filePath) {
     BasicMetadata basicMetadata;
@@ -45,333 +52,563 @@ BasicMetadata extractBasicMetadata(const std::filesystem::path& filePath) {
     return basicMetadata;
 }
 
-bool readGifLogicalScreenDescriptor(const std::filesystem::path& filePath, LogicalScreenDescriptor& lsd) {
+CustomMap<std::string, std::string> analyzeBasicMetadata(const std::filesystem::path& filePath) {
+    BasicMetadata basicMetadata = extractBasicMetadata(filePath);
+
+    CustomMap<std::string, std::string> metadata;
+    metadata["FileName"] = basicMetadata.fileName;
+    metadata["FileSize"] = basicMetadata.fileSize;
+    metadata["FileType"] = basicMetadata.fileType;
+    metadata["CreationTime"] = basicMetadata.creationTime;
+    metadata["LastModified"] = basicMetadata.lastModified;
+    metadata["LastAccess"] = basicMetadata.lastAccess;
+    return metadata;
+}
+
+bool readFilePrefix(const std::filesystem::path& filePath, std::size_t length, std::vector<uint8_t>& bytes) {
     std::ifstream file(filePath, std::ios::binary);
     if (!file.is_open()) {
         return false;
     }
 
-    // Read Logical Screen Descriptor
-    file.read(reinterpret_cast<char*>(&lsd), sizeof(LogicalScreenDescriptor));
-    file.close();
+    std::error_code ec;
+    const auto fileSize = std::filesystem::file_size(filePath, ec);
+    if (!ec) {
+        length = std::min<std::uintmax_t>(length, fileSize);
+    }
 
+    bytes.resize(length);
+    file.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(length));
+    bytes.resize(static_cast<std::size_t>(file.gcount()));
     return true;
 }
 
-void custom_assert(bool condition, const char* message) {
-    if (!condition) {
-        std::cerr << "Assertion failed: " << message << std::endl;
-        // Additional error handling code here, like logging, reporting, etc.
-        // You can also throw an exception or terminate the program if necessary
-        // For demonstration, let's terminate the program
-        throw std::runtime_error("Assertion failed");
+bool extendFilePrefix(const std::filesystem::path& filePath, std::size_t length, std::vector<uint8_t>& bytes) {
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::error_code ec;
+    const auto fileSize = std::filesystem::file_size(filePath, ec);
+    if (!ec) {
+        length = std::min<std::uintmax_t>(length, fileSize);
     }
+    if (length <= bytes.size()) {
+        return true;
+    }
+
+    const std::size_t start = bytes.size();
+    file.seekg(static_cast<std::streamoff>(start));
+    bytes.resize(length);
+    file.read(reinterpret_cast<char*>(bytes.data() + start), static_cast<std::streamsize>(length - start));
+    bytes.resize(start + static_cast<std::size_t>(file.gcount()));
+    return true;
 }
 
 /**
- * @brief Helper function to analyze the metadata of a file based on its type.
- *
- * This function uses template specialization to handle the metadata extraction for each supported file type.
+ * @brief Copies a fixed-size header out of a buffer.
  *
- * @tparam T The file header type.
- * @param filePath The path to the file.
- * @return A `CustomMap` containing the extracted metadata.
+ * Missing trailing bytes are left zeroed, so short files yield zero fields instead of garbage.
  */
-template <typename T>
-CustomMap<std::string, std::string> analyzeMetadataHelper(const std::filesystem::path& filePath) {
-    CustomMap<std::string, std::string> metadata ;
-    std::string extension = filePath.extension().string();
-
-    if constexpr (std::is_same_v<T, BasicMetadata>)
-    {
-        BasicMetadata basicMetadata = extractBasicMetadata(filePath);
-
-        // return custom map of basic metadata;
-        // store bsic metadata in custom map
-        metadata["FileName"] = basicMetadata.fileName;
-        metadata["FileSize"] = basicMetadata.fileSize;
-        metadata["FileType"] = basicMetadata.fileType;
-        metadata["CreationTime"] = basicMetadata.creationTime;
-        metadata["LastModified"] = basicMetadata.lastModified;
-        metadata["LastAccess"] = basicMetadata.lastAccess;
-        
-        return metadata;
+template <typename Header>
+Header readHeader(std::span<const uint8_t> bytes) {
+    Header header{};
+    if (!bytes.empty()) {
+        std::memcpy(&header, bytes.data(), std::min(bytes.size(), sizeof(Header)));
+    }
+    return header;
+}
 
+/**
+ * @brief Collects the archive level metadata of an opened ZIP archive.
+ *
+ * The archive size comes from the caller: libzip only stats members, and an entry
+ * lookup by an empty name fails rather than describing the archive.
+ */
+void extractZipMetadata(zip_t* zip, std::uintmax_t archiveSize, CustomMap<std::string, std::string>& metadata) {
+    metadata["FileType"] = "ZIP";
+    metadata["FileSize"] = std::to_string(archiveSize) + " bytes";
+
+    // Get the ZIP archive comment
+    int commentLength = 0;
+    const char* comment = zip_get_archive_comment(zip, &commentLength, 0);
+    if (comment && commentLength > 0) {
+        metadata["Comment"] = std::string(comment, commentLength);
     }
-    else if constexpr (std::is_same_v<T, poppler::document>) {
-
-        custom_assert(extension == ".pdf" , "Unexpected file extension for PDF metadata");
-        // PDF metadata extraction logic
-        poppler::document* doc = poppler::document::load_from_file(filePath.string());
-        if (!doc || doc->is_locked()) {
-            delete doc;
-            return metadata;
+
+    // Describe the first entry from the central directory instead of its contents
+    zip_stat_t entryStat;
+    if (zip_get_num_entries(zip, 0) > 0 && zip_stat_index(zip, 0, 0, &entryStat) == 0) {
+        if (entryStat.valid & ZIP_STAT_NAME) {
+            metadata["FileName"] = entryStat.name;
+        }
+        if (entryStat.valid & ZIP_STAT_COMP_SIZE) {
+            metadata["CompressedSize"] = std::to_string(entryStat.comp_size) + " bytes";
+        }
+        if (entryStat.valid & ZIP_STAT_COMP_METHOD) {
+            metadata["CompressionMethod"] = std::to_string(entryStat.comp_method);
+        }
+        if (entryStat.valid & ZIP_STAT_MTIME) {
+            metadata["LastModificationTime"] = std::ctime(&entryStat.mtime);
+        }
+        if (entryStat.valid & ZIP_STAT_CRC) {
+            metadata["CRC32"] = std::to_string(entryStat.crc);
         }
+        if (entryStat.valid & ZIP_STAT_SIZE) {
+            metadata["UncompressedSize"] = std::to_string(entryStat.size) + " bytes";
+        }
+    }
+}
 
-        metadata["Title"] = std::string(doc->get_title().begin(), doc->get_title().end());
-        metadata["Author"] = std::string(doc->get_author().begin(), doc->get_author().end());
-        metadata["Subject"] = std::string(doc->get_subject().begin(), doc->get_subject().end());
-        metadata["Keywords"] = std::string(doc->get_keywords().begin(), doc->get_keywords().end());
-        metadata["Creator"] = std::string(doc->get_creator().begin(), doc->get_creator().end());
-        metadata["Producer"] = std::string(doc->get_producer().begin(), doc->get_producer().end());
-        metadata["CreationDate"] = doc->get_creation_date();
-        metadata["ModificationDate"] = doc->get_modification_date();
-        metadata["FileType"] = "PDF";
-        delete doc;
-    } else if constexpr (std::is_same_v<T, std::ifstream>) {
+/**
+ * @brief Rejects malformed input by throwing; the message is left to the caller to report.
+ *
+ * Nothing is written to stderr, as the parsers also run inside the C library.
+ */
+void custom_assert(bool condition, const char* message) {
+    if (!condition) {
+        throw std::runtime_error(std::string("Assertion failed: ").append(message));
+    }
+}
 
-        custom_assert(extension == ".txt" , "Unexpected file extension for TXT metadata");
+/**
+ * @brief Parses the BMP file header and its DIB header from little-endian byte offsets.
+ *
+ * Handles BITMAPCOREHEADER, BITMAPINFOHEADER (with trailing bitfield masks), the V2/V3
+ * info headers, OS/2 2.x, BITMAPV4HEADER and BITMAPV5HEADER. Only the header region is
+ * read; the palette and ICC profile are located but never touched.
+ */
+BMPHeader parseBMPHeader(std::span<const uint8_t> bytes) {
+    custom_assert(bytes.size() >= BMPFileHeaderSize + 4, "Truncated BMP header");
+
+    BMPHeader header{};
+    header.signature[0] = static_cast<char>(bytes[0]);
+    header.signature[1] = static_cast<char>(bytes[1]);
+    header.fileSize = readLE32(bytes, 2);
+    header.dataOffset = readLE32(bytes, 10);
+    header.dibHeaderSize = readLE32(bytes, 14);
+
+    const uint32_t dibSize = header.dibHeaderSize;
+    custom_assert(dibSize == 12 || dibSize == 40 || dibSize == 52 || dibSize == 56 || dibSize == 64 || dibSize == 108 || dibSize == 124,
+                  "Unsupported BMP DIB header size");
+    custom_assert(bytes.size() >= BMPFileHeaderSize + dibSize, "Truncated BMP DIB header");
+
+    const std::size_t dib = BMPFileHeaderSize;
+    std::size_t paletteEntrySize = 4;
+    std::size_t trailingMaskBytes = 0;
+
+    if (dibSize == 12) {
+        // BITMAPCOREHEADER: unsigned 16-bit dimensions, RGB triples in the palette
+        header.width = readLE16(bytes, dib + 4);
+        header.height = readLE16(bytes, dib + 6);
+        header.planes = readLE16(bytes, dib + 8);
+        header.bitCount = readLE16(bytes, dib + 10);
+        paletteEntrySize = 3;
+    } else {
+        header.width = static_cast<int32_t>(readLE32(bytes, dib + 4));
+        header.height = static_cast<int32_t>(readLE32(bytes, dib + 8));
+        header.planes = readLE16(bytes, dib + 12);
+        header.bitCount = readLE16(bytes, dib + 14);
+        header.compression = readLE32(bytes, dib + 16);
+        header.imageSize = readLE32(bytes, dib + 20);
+        header.xPixelsPerMeter = static_cast<int32_t>(readLE32(bytes, dib + 24));
+        header.yPixelsPerMeter = static_cast<int32_t>(readLE32(bytes, dib + 28));
+        header.colorsUsed = readLE32(bytes, dib + 32);
+        header.colorsImportant = readLE32(bytes, dib + 36);
+
+        // Masks live inside V2+ headers, or straight after a plain INFO header for (alpha) bitfields
+        std::size_t maskCount = 0;
+        if (dibSize == 52) {
+            maskCount = 3;
+        } else if (dibSize == 56 || dibSize >= 108) {
+            maskCount = 4;
+        } else if (dibSize == 40 && (header.compression == 3 || header.compression == 6)) {
+            maskCount = header.compression == 6 ? 4 : 3;
+            trailingMaskBytes = maskCount * 4;
+            custom_assert(bytes.size() >= dib + dibSize + trailingMaskBytes, "Truncated BMP bitfield masks");
+        }
 
-        // TXT metadata extraction logic
-        std::ifstream file(filePath);
-        if (!file.is_open()) {
-            return metadata;
+        uint32_t* masks[] = {&header.redMask, &header.greenMask, &header.blueMask, &header.alphaMask};
+        for (std::size_t i = 0; i < maskCount; ++i) {
+            *masks[i] = readLE32(bytes, dib + 40 + i * 4);
         }
 
-        std::stringstream buffer;
-        buffer << file.rdbuf();
-        std::string fileContent = buffer.str();
+        if (dibSize >= 108) {
+            header.colorSpaceType = readLE32(bytes, dib + 56);
+        }
+        if (dibSize >= 124) {
+            header.profileOffset = readLE32(bytes, dib + 112);
+            header.profileSize = readLE32(bytes, dib + 116);
+        }
+    }
+
+    // The color table follows the headers; when colorsUsed is 0 indexed images use the full 2^bitCount entries
+    header.paletteOffset = static_cast<uint32_t>(dib + dibSize + trailingMaskBytes);
+    header.paletteEntries = header.colorsUsed ? header.colorsUsed
+                          : (header.bitCount >= 1 && header.bitCount <= 8) ? (1u << header.bitCount) : 0;
+    if (header.dataOffset > header.paletteOffset) {
+        // Never report more entries than fit between the headers and the pixel data
+        header.paletteEntries = std::min<uint32_t>(header.paletteEntries, static_cast<uint32_t>((header.dataOffset - header.paletteOffset) / paletteEntrySize));
+    }
+    return header;
+}
 
-        std::string line;
-        std::getline(file, line);
-        if (!line.empty()) {
-            metadata["Title"] = line;
+JPEGHeader parseJPEGHeader(std::span<const uint8_t> bytes) {
+    JPEGHeader header{};
+    std::size_t position = 2; // after SOI
+    bool first = true;
+    while (position + 4 <= bytes.size() && bytes[position] == 0xFF) {
+        const uint8_t marker = bytes[position + 1];
+        if (marker == 0xFF) {
+            // Fill byte before a marker
+            ++position;
+            continue;
+        }
+        if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD8)) {
+            // TEM, RSTn and SOI stand alone without a length
+            position += 2;
+            continue;
+        }
+        if (marker == 0xD9 || marker == 0xDA) {
+            // EOI or start of scan: there is no frame header before the entropy-coded data
+            break;
         }
 
-        std::getline(file, line);
-        if (!line.empty()) {
-            metadata["Author"] = line;
+        const std::size_t length = readBE16(bytes, position + 2);
+        if (length < 2) {
+            break;
+        }
+        const std::size_t segment = position + 4;
+        const std::size_t segmentEnd = position + 2 + length;
+
+        if (first) {
+            header.marker = static_cast<uint16_t>(0xFF00 | marker);
+            header.length = static_cast<uint16_t>(length);
+            first = false;
+            if (marker == 0xE0 && length >= 16 && segmentEnd <= bytes.size() && std::memcmp(&bytes[segment], "JFIF", 5) == 0) {
+                std::memcpy(header.identifier, &bytes[segment], 5);
+                header.version = readBE16(bytes, segment + 5);
+                header.units = bytes[segment + 7];
+                header.xDensity = readBE16(bytes, segment + 8);
+                header.yDensity = readBE16(bytes, segment + 10);
+                header.thumbWidth = bytes[segment + 12];
+                header.thumbHeight = bytes[segment + 13];
+            }
         }
 
-        // Extract other TXT metadata...
+        // SOF0-SOF15, except DHT (C4), JPG (C8) and DAC (CC) which share the range
+        if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC) {
+            if (length >= 7 && segment + 5 <= bytes.size()) {
+                header.frameMarker = marker;
+                header.height = readBE16(bytes, segment + 1);
+                header.width = readBE16(bytes, segment + 3);
+            }
+            break;
+        }
+        position = segmentEnd;
+    }
+    return header;
+}
 
-        metadata["FileName"] = filePath.filename().string();
-        metadata["FileSize"] = std::to_string(fileContent.size()) + " bytes";
-        metadata["FileType"] = "TXT";
-        file.close();
-    } else if constexpr (std::is_same_v<T, JPEGHeader>) {
+std::string bmpDibHeaderName(uint32_t dibHeaderSize) {
+    switch (dibHeaderSize) {
+        case 12:  return "BITMAPCOREHEADER";
+        case 40:  return "BITMAPINFOHEADER";
+        case 52:  return "BITMAPV2INFOHEADER";
+        case 56:  return "BITMAPV3INFOHEADER";
+        case 64:  return "OS22XBITMAPHEADER";
+        case 108: return "BITMAPV4HEADER";
+        case 124: return "BITMAPV5HEADER";
+        default:  return std::to_string(dibHeaderSize);
+    }
+}
 
-        custom_assert(extension == ".jpg" , "Unexpected file extension for JPEG metadata");
+std::string bmpCompressionName(uint32_t compression) {
+    switch (compression) {
+        case 0:  return "BI_RGB";
+        case 1:  return "BI_RLE8";
+        case 2:  return "BI_RLE4";
+        case 3:  return "BI_BITFIELDS";
+        case 4:  return "BI_JPEG";
+        case 5:  return "BI_PNG";
+        case 6:  return "BI_ALPHABITFIELDS";
+        case 11: return "BI_CMYK";
+        case 12: return "BI_CMYKRLE8";
+        case 13: return "BI_CMYKRLE4";
+        default: return std::to_string(compression);
+    }
+}
 
-        // JPEG metadata extraction logic
-        std::ifstream file(filePath, std::ios::binary);
-        if (!file.is_open()) {
-            return metadata;
-        }
+std::string bmpColorSpaceName(uint32_t colorSpaceType) {
+    switch (colorSpaceType) {
+        case 0x00000000: return "Calibrated RGB";
+        case 0x73524742: return "sRGB";            // 'sRGB'
+        case 0x57696E20: return "Windows default"; // 'Win '
+        case 0x4C494E4B: return "Linked profile";  // 'LINK'
+        case 0x4D424544: return "Embedded profile"; // 'MBED'
+        default:         return std::to_string(colorSpaceType);
+    }
+}
 
-        JPEGHeader header;
-        file.read(reinterpret_cast<char*>(&header), sizeof(JPEGHeader));
-        file.close();
+std::string hexMask(uint32_t mask) {
+    char text[11];
+    std::snprintf(text, sizeof(text), "0x%08X", mask);
+    return text;
+}
 
-        metadata["FileType"] = "JPEG";
-        metadata["Marker"] = std::to_string(header.marker);
-        metadata["Length"] = std::to_string(header.length);
-        metadata["Identifier"] = std::string(reinterpret_cast<char*>(header.identifier), 5);
-        metadata["Version"] = std::to_string(header.version);
-        metadata["Units"] = std::to_string(static_cast<int>(header.units));
-        metadata["XDensity"] = std::to_string(header.xDensity);
-        metadata["YDensity"] = std::to_string(header.yDensity);
-        metadata["ThumbnailWidth"] = std::to_string(static_cast<int>(header.thumbWidth));
-        metadata["ThumbnailHeight"] = std::to_string(static_cast<int>(header.thumbHeight));
-    } else if constexpr (std::is_same_v<T, PNGHeader>) {
-        custom_assert(extension == ".png" , "Unexpected file extension for PNG metadata");
+namespace {
 
-        // PNG metadata extraction logic
-        std::ifstream file(filePath, std::ios::binary);
-        if (!file.is_open()) {
-            return metadata;
-        }
+// Enough of a text file for the title and author lines
+constexpr std::size_t TXTHeaderRegion = 4096;
+// GIF signature and version followed by the logical screen descriptor
+constexpr std::size_t GIFHeaderRegion = sizeof(GIFHeader) + sizeof(LogicalScreenDescriptor);
 
-        PNGHeader header;
-        file.read(reinterpret_cast<char*>(&header), sizeof(PNGHeader));
-        file.close();
+template <const auto& Signature>
+bool hasSignature(std::span<const uint8_t> bytes) {
+    return bytes.size() >= sizeof(Signature) && std::memcmp(bytes.data(), Signature, sizeof(Signature)) == 0;
+}
 
-        metadata["FileType"] = "PNG";
-        metadata["Signature"] = std::string(reinterpret_cast<char*>(header.signature), 8);
-        metadata["Width"] = std::to_string(header.width);
-        metadata["Height"] = std::to_string(header.height);
-    } else if constexpr (std::is_same_v<T, BMPHeader>) {
+/**
+ * @brief Reads the document information of a PDF opened by poppler and releases it.
+ */
+CustomMap<std::string, std::string> pdfMetadata(poppler::document* doc) {
+    CustomMap<std::string, std::string> metadata;
+    if (!doc || doc->is_locked()) {
+        delete doc;
+        return metadata;
+    }
 
-        custom_assert(extension == ".bmp" , "Unexpected file extension for BMP metadata");
+    metadata["Title"] = std::string(doc->get_title().begin(), doc->get_title().end());
+    metadata["Author"] = std::string(doc->get_author().begin(), doc->get_author().end());
+    metadata["Subject"] = std::string(doc->get_subject().begin(), doc->get_subject().end());
+    metadata["Keywords"] = std::string(doc->get_keywords().begin(), doc->get_keywords().end());
+    metadata["Creator"] = std::string(doc->get_creator().begin(), doc->get_creator().end());
+    metadata["Producer"] = std::string(doc->get_producer().begin(), doc->get_producer().end());
+    metadata["CreationDate"] = doc->get_creation_date();
+    metadata["ModificationDate"] = doc->get_modification_date();
+    metadata["FileType"] = "PDF";
+    delete doc;
+    return metadata;
+}
 
-    // BMP metadata extraction logic
-        std::ifstream file(filePath, std::ios::binary);
-        if (!file.is_open()) {
-            return metadata;
-        }
+CustomMap<std::string, std::string> parsePDF(std::span<const uint8_t> bytes, const std::filesystem::path&) {
+    // poppler takes an int length
+    if (bytes.size() > static_cast<std::size_t>(INT_MAX)) {
+        return {};
+    }
+    return pdfMetadata(poppler::document::load_from_raw_data(reinterpret_cast<const char*>(bytes.data()), static_cast<int>(bytes.size())));
+}
 
-        BMPHeader header;
-        file.read(reinterpret_cast<char*>(&header), sizeof(BMPHeader));
-        file.close();
+CustomMap<std::string, std::string> parsePDFFile(const std::filesystem::path& filePath) {
+    return pdfMetadata(poppler::document::load_from_file(filePath.string()));
+}
 
-        metadata["FileType"] = "BMP";
-        metadata["Signature"] = std::string(header.signature, 2);
-        metadata["FileSize"] = std::to_string(header.fileSize);
-        metadata["Width"] = std::to_string(header.width);
-        metadata["Height"] = std::to_string(header.height);
-    } else if constexpr (std::is_same_v<T, ZIPHeader>) {
+CustomMap<std::string, std::string> parseTXT(std::span<const uint8_t> bytes, const std::filesystem::path& name) {
+    CustomMap<std::string, std::string> metadata;
+    std::istringstream text(std::string(reinterpret_cast<const char*>(bytes.data()), bytes.size()));
 
-        custom_assert(extension == ".zip" , "Unexpected file extension for ZIP metadata");
+    std::string line;
+    std::getline(text, line);
+    if (!line.empty()) {
+        metadata["Title"] = line;
+    }
 
-        // ZIP metadata extraction logic
-        int error;
-        zip_t* zip = zip_open(filePath.string().c_str(), 0, &error);
-        if (!zip) {
-            // Handle the error code in `error`
-            return metadata;
-        }
+    std::getline(text, line);
+    if (!line.empty()) {
+        metadata["Author"] = line;
+    }
 
-        // Get the overall ZIP file information
-        zip_stat_t zipStat;
-        if (zip_stat(zip, "", 0, &zipStat) == 0) {
-            metadata["FileType"] = "ZIP";
-            metadata["FileSize"] = std::to_string(zipStat.size) + " bytes";
-        }
+    // Extract other TXT metadata...
 
-        // Get the ZIP archive comment
-        int commentLength;
-        const char* comment = zip_get_archive_comment(zip, &commentLength, 0);
-        if (commentLength > 0) {
-            metadata["Comment"] = std::string(comment, commentLength);
-        }
+    metadata["FileName"] = name.filename().string();
+    metadata["FileType"] = "TXT";
+    return metadata;
+}
 
-        // Get the first file in the ZIP archive
-        zip_file_t* file = zip_fopen_index(zip, 0, 0);
-        if (file) {
-            ZIPHeader header;
-            zip_fread(file, &header, sizeof(ZIPHeader));
-
-            // Extract metadata from the ZIP header
-            metadata["FileName"] = std::string(reinterpret_cast<char*>(header.fileNameLength + 1), header.fileNameLength);
-            metadata["CompressedSize"] = std::to_string(header.compressedSize) + " bytes";
-            metadata["CompressionMethod"] = std::to_string(header.compressionMethod);
-            metadata["LastModificationTime"] = std::to_string(header.lastModTime);
-            metadata["LastModificationDate"] = std::to_string(header.lastModDate);
-            metadata["CRC32"] = std::to_string(header.crc32);
-            metadata["UncompressedSize"] = std::to_string(header.uncompressedSize) + " bytes";
-
-            zip_fclose(file);
-        }
+CustomMap<std::string, std::string> parseJPEG(std::span<const uint8_t> bytes, const std::filesystem::path&) {
+    CustomMap<std::string, std::string> metadata;
+    JPEGHeader header = parseJPEGHeader(bytes);
 
-        zip_close(zip);
-    } else if constexpr (std::is_same_v<T, WAVHeader>) {
+    metadata["FileType"] = "JPEG";
+    metadata["Marker"] = std::to_string(header.marker);
+    metadata["Length"] = std::to_string(header.length);
+    if (header.identifier[0]) {
+        metadata["Identifier"] = std::string(reinterpret_cast<char*>(header.identifier), strnlen(reinterpret_cast<char*>(header.identifier), 5));
+        metadata["Version"] = std::to_string(header.version);
+        metadata["Units"] = std::to_string(static_cast<int>(header.units));
+        metadata["XDensity"] = std::to_string(header.xDensity);
+        metadata["YDensity"] = std::to_string(header.yDensity);
+        metadata["ThumbnailWidth"] = std::to_string(static_cast<int>(header.thumbWidth));
+        metadata["ThumbnailHeight"] = std::to_string(static_cast<int>(header.thumbHeight));
+    }
+    if (header.frameMarker) {
+        metadata["Width"] = std::to_string(header.width);
+        metadata["Height"] = std::to_string(header.height);
+    }
+    return metadata;
+}
 
-        custom_assert(extension == ".wav" , "Unexpected file extension for WAV metadata");
+CustomMap<std::string, std::string> parsePNG(std::span<const uint8_t> bytes, const std::filesystem::path&) {
+    CustomMap<std::string, std::string> metadata;
+    PNGHeader header = readHeader<PNGHeader>(bytes);
 
-        //WAV metadata extraction logic
-        std::ifstream file(filePath, std::ios::binary);
-        if (!file.is_open()) {
-            return metadata;
-        }
+    metadata["FileType"] = "PNG";
+    metadata["Signature"] = std::string(reinterpret_cast<char*>(header.signature), 8);
+    metadata["Width"] = std::to_string(be32toh(header.width));
+    metadata["Height"] = std::to_string(be32toh(header.height));
+    return metadata;
+}
 
-        WAVHeader header;
-        file.read(reinterpret_cast<char*>(&header), sizeof(WAVHeader));
-        file.close();
-
-        metadata["FileType"] = "WAV";
-        metadata["RIFFTag"] = std::string(header.riffTag, 4);
-        metadata["RIFFSize"] = std::to_string(header.riffSize);
-        metadata["WAVETag"] = std::string(header.waveTag, 4);
-        metadata["FMTTag"] = std::string(header.fmtTag, 4);
-        metadata["FMTSize"] = std::to_string(header.fmtSize);
-        metadata["AudioFormat"] = std::to_string(header.audioFormat);
-        metadata["NumChannels"] = std::to_string(header.numChannels);
-        metadata["SampleRate"] = std::to_string(header.sampleRate);
-        metadata["ByteRate"] = std::to_string(header.byteRate);
-        metadata["BlockAlign"] = std::to_string(header.blockAlign);
-        metadata["BitsPerSample"] = std::to_string(header.bitsPerSample);
-        metadata["DataTag"] = std::string(header.dataTag, 4);
-        metadata["DataSize"] = std::to_string(header.dataSize);
-    }else if constexpr (std::is_same_v<T, GIFHeader>) {
-        custom_assert(extension == ".gif" , "Unexpected file extension for GIF metadata");
-
-        // GIF metadata extraction logic
-        std::ifstream file(filePath, std::ios::binary);
-        if (!file.is_open()) {
-            return metadata;
-        }
+CustomMap<std::string, std::string> parseBMP(std::span<const uint8_t> bytes, const std::filesystem::path&) {
+    CustomMap<std::string, std::string> metadata;
+    BMPHeader header = parseBMPHeader(bytes);
+
+    metadata["FileType"] = "BMP";
+    metadata["Signature"] = std::string(header.signature, 2);
+    metadata["FileSize"] = std::to_string(header.fileSize);
+    metadata["DataOffset"] = std::to_string(header.dataOffset);
+    metadata["DIBHeader"] = bmpDibHeaderName(header.dibHeaderSize);
+    metadata["Width"] = std::to_string(header.width);
+    metadata["Height"] = std::to_string(header.height < 0 ? -static_cast<int64_t>(header.height) : header.height);
+    metadata["Orientation"] = header.height < 0 ? "top-down" : "bottom-up";
+    metadata["Planes"] = std::to_string(header.planes);
+    metadata["BitCount"] = std::to_string(header.bitCount);
+
+    if (header.dibHeaderSize > 12) {
+        metadata["Compression"] = bmpCompressionName(header.compression);
+        metadata["ImageSize"] = std::to_string(header.imageSize);
+        metadata["XPixelsPerMeter"] = std::to_string(header.xPixelsPerMeter);
+        metadata["YPixelsPerMeter"] = std::to_string(header.yPixelsPerMeter);
+        metadata["ColorsUsed"] = std::to_string(header.colorsUsed);
+        metadata["ColorsImportant"] = std::to_string(header.colorsImportant);
+    }
+    if (header.redMask || header.greenMask || header.blueMask || header.alphaMask) {
+        metadata["RedMask"] = hexMask(header.redMask);
+        metadata["GreenMask"] = hexMask(header.greenMask);
+        metadata["BlueMask"] = hexMask(header.blueMask);
+        metadata["AlphaMask"] = hexMask(header.alphaMask);
+    }
+    if (header.paletteEntries > 0) {
+        metadata["PaletteEntries"] = std::to_string(header.paletteEntries);
+        metadata["PaletteOffset"] = std::to_string(header.paletteOffset);
+    }
+    if (header.dibHeaderSize >= 108) {
+        metadata["ColorSpace"] = bmpColorSpaceName(header.colorSpaceType);
+    }
+    if (header.dibHeaderSize >= 124 && header.profileSize > 0) {
+        // The profile offset is relative to the DIB header; report it from the start of the file
+        metadata["ICCProfileOffset"] = std::to_string(BMPFileHeaderSize + static_cast<uint64_t>(header.profileOffset));
+        metadata["ICCProfileSize"] = std::to_string(header.profileSize);
+    }
+    return metadata;
+}
 
-        GIFHeader header;
-        file.read(reinterpret_cast<char*>(&header), sizeof(GIFHeader));
-        file.close();
-
-        metadata["FileType"] = "GIF";
-        metadata["Signature"] = std::string(header.signature, 3);
-        metadata["Version"] = std::string(header.version, 3);
-        // Include additional metadata extraction for GIF files if needed
-    } else if constexpr (std::is_same_v<T, LogicalScreenDescriptor>) {
-
-        custom_assert(extension == ".gif" , "Unexpected file extension for GIF metadata");
-        // GIF metadata extraction logic
-        LogicalScreenDescriptor lsd;
-        if (!readGifLogicalScreenDescriptor(filePath, lsd)) {
-            return metadata;
+CustomMap<std::string, std::string> parseZIP(std::span<const uint8_t> bytes, const std::filesystem::path&) {
+    CustomMap<std::string, std::string> metadata;
+
+    // Read the archive straight from the buffer
+    zip_error_t error;
+    zip_error_init(&error);
+    zip_source_t* source = zip_source_buffer_create(bytes.data(), bytes.size(), 0, &error);
+    zip_t* zip = source ? zip_open_from_source(source, ZIP_RDONLY, &error) : nullptr;
+    zip_error_fini(&error);
+    if (!zip) {
+        if (source) {
+            zip_source_free(source);
         }
-
-        metadata["FileType"] = "GIF";
-        metadata["Width"] = std::to_string(lsd.width);
-        metadata["Height"] = std::to_string(lsd.height);
-        metadata["PackedFields"] = std::to_string(lsd.packedFields);
-        metadata["BackgroundColorIndex"] = std::to_string(lsd.backgroundColorIndex);
-        metadata["PixelAspectRatio"] = std::to_string(lsd.pixelAspectRatio);
+        return metadata;
     }
 
+    extractZipMetadata(zip, bytes.size(), metadata);
+    zip_close(zip);
     return metadata;
 }
 
-/**
- * @brief Determines the file type based on the file signature.
- *
- * This function uses a fold expression to check the file signature and return the corresponding `FileType`.
- *
- * @tparam T The supported file header types.
- * @param filePath The path to the file.
- * @return The determined file type.
- */
-template <typename... T>
-requires (sizeof...(T) > 0)
-FileType determineFileType(const std::filesystem::path& filePath) {
-    std::ifstream file(filePath, std::ios::binary);
-    if (!file.is_open()) {
-        return FileType::UNKNOWN;
+CustomMap<std::string, std::string> parseZIPFile(const std::filesystem::path& filePath) {
+    CustomMap<std::string, std::string> metadata;
+    int error;
+    zip_t* zip = zip_open(filePath.string().c_str(), 0, &error);
+    if (!zip) {
+        // Handle the error code in `error`
+        return metadata;
     }
 
-    uint8_t signature[8];
-    file.read(reinterpret_cast<char*>(signature), sizeof(signature));
-
-    // Fold expression to check the file signature
-    return (
-        [&]() -> FileType {
-            return (
-                (std::memcmp(signature, JPEGSignature, sizeof(JPEGSignature)) == 0) ? FileType::JPEG :
-                (std::memcmp(signature, PNGSignature, sizeof(PNGSignature)) == 0) ? FileType::PNG :
-                (std::memcmp(signature, BMPSignature, sizeof(BMPSignature)) == 0) ? FileType::BMP :
-                (signature[0] == '%' && signature[1] == 'P' && signature[2] == 'D' && signature[3] == 'F') ? FileType::PDF :
-                (std::memcmp(signature, ZIPSignature, sizeof(ZIPSignature)) == 0) ? FileType::ZIP :
-                (std::memcmp(signature, WAVSignature, sizeof(WAVSignature)) == 0) ? FileType::WAV :
-                (std::memcmp(signature, GIFSignature, sizeof(GIFSignature)) == 0) ? FileType::GIF : // Add GIF detection
-                FileType::TXT
-            );
-        }()
-    );
+    std::error_code ec;
+    const std::uintmax_t archiveSize = std::filesystem::file_size(filePath, ec);
+    extractZipMetadata(zip, ec ? 0 : archiveSize, metadata);
+    zip_close(zip);
+    return metadata;
 }
 
+CustomMap<std::string, std::string> parseWAV(std::span<const uint8_t> bytes, const std::filesystem::path&) {
+    CustomMap<std::string, std::string> metadata;
+    WAVHeader header = readHeader<WAVHeader>(bytes);
+
+    metadata["FileType"] = "WAV";
+    metadata["RIFFTag"] = std::string(header.riffTag, 4);
+    metadata["RIFFSize"] = std::to_string(header.riffSize);
+    metadata["WAVETag"] = std::string(header.waveTag, 4);
+    metadata["FMTTag"] = std::string(header.fmtTag, 4);
+    metadata["FMTSize"] = std::to_string(header.fmtSize);
+    metadata["AudioFormat"] = std::to_string(header.audioFormat);
+    metadata["NumChannels"] = std::to_string(header.numChannels);
+    metadata["SampleRate"] = std::to_string(header.sampleRate);
+    metadata["ByteRate"] = std::to_string(header.byteRate);
+    metadata["BlockAlign"] = std::to_string(header.blockAlign);
+    metadata["BitsPerSample"] = std::to_string(header.bitsPerSample);
+    metadata["DataTag"] = std::string(header.dataTag, 4);
+    metadata["DataSize"] = std::to_string(header.dataSize);
+    return metadata;
+}
 
-// Explicit template instantiations for the supported file header types
-template FileType determineFileType<poppler::document, std::ifstream, JPEGHeader, PNGHeader, BMPHeader, ZIPHeader, WAVHeader,GIFHeader>(const std::filesystem::path& filePath);
-
+CustomMap<std::string, std::string> parseGIF(std::span<const uint8_t> bytes, const std::filesystem::path&) {
+    CustomMap<std::string, std::string> metadata;
+    GIFHeader header = readHeader<GIFHeader>(bytes);
+    // The logical screen descriptor follows the 6-byte signature and version
+    LogicalScreenDescriptor lsd = readHeader<LogicalScreenDescriptor>(bytes.subspan(std::min(bytes.size(), sizeof(GIFHeader))));
+
+    metadata["FileType"] = "GIF";
+    metadata["Signature"] = std::string(header.signature, 3);
+    metadata["Version"] = std::string(header.version, 3);
+    metadata["Width"] = std::to_string(lsd.width);
+    metadata["Height"] = std::to_string(lsd.height);
+    metadata["PackedFields"] = std::to_string(lsd.packedFields);
+    metadata["BackgroundColorIndex"] = std::to_string(lsd.backgroundColorIndex);
+    metadata["PixelAspectRatio"] = std::to_string(lsd.pixelAspectRatio);
+    return metadata;
+}
 
-// Explicit template instantiations for the supported file header types
-// template FileType determineFileType<poppler::document, std::ifstream, JPEGHeader, PNGHeader, BMPHeader, ZIPHeader, WAVHeader>(const std::filesystem::path& filePath);
+// Content pass for the image formats: perceptual hashes of the decoded image, if it decodes
+template <FileType Type>
+CustomMap<std::string, std::string> hashImage(std::span<const uint8_t> bytes) {
+    CustomMap<std::string, std::string> metadata;
+    if (auto hash = computePerceptualHash(Type, bytes)) {
+        metadata["DHash"] = formatHash(hash->dHash);
+        metadata["PHash"] = formatHash(hash->pHash);
+    }
+    return metadata;
+}
 
-// Explicit template instantiations for the FileMetaDataAnalyzer class
-template CustomMap<std::string, std::string> FileMetaDataAnalyzer<poppler::document>::analyzeMetadata(const std::filesystem::path& filePath);
-template CustomMap<std::string, std::string> FileMetaDataAnalyzer<std::ifstream>::analyzeMetadata(const std::filesystem::path& filePath);
-template CustomMap<std::string, std::string> FileMetaDataAnalyzer<JPEGHeader>::analyzeMetadata(const std::filesystem::path& filePath);
-template CustomMap<std::string, std::string> FileMetaDataAnalyzer<PNGHeader>::analyzeMetadata(const std::filesystem::path& filePath);
-template CustomMap<std::string, std::string> FileMetaDataAnalyzer<BMPHeader>::analyzeMetadata(const std::filesystem::path& filePath);
-template CustomMap<std::string, std::string> FileMetaDataAnalyzer<ZIPHeader>::analyzeMetadata(const std::filesystem::path& filePath);
-template CustomMap<std::string, std::string> FileMetaDataAnalyzer<WAVHeader>::analyzeMetadata(const std::filesystem::path& filePath);
-template CustomMap<std::string, std::string> FileMetaDataAnalyzer<GIFHeader>::analyzeMetadata(const std::filesystem::path& filePath);
-template CustomMap<std::string, std::string> FileMetaDataAnalyzer<LogicalScreenDescriptor>::analyzeMetadata(const std::filesystem::path& filePath);
-template CustomMap<std::string, std::string> FileMetaDataAnalyzer<BasicMetadata>::analyzeMetadata(const std::filesystem::path& filePath);
+/**
+ * @brief The built-in formats, in registration order.
+ *
+ * This is the only place a built-in format is declared: write its parse function above and
+ * add a row here. Sniffing tries later rows first; TXT has no signature and is the fallback.
+ */
+const ExtractorDescriptor builtinTable[] = {
+    {"TXT",  FileType::TXT,  nullptr,                     TXTHeaderRegion,     CostClass::Header,   parseTXT,  nullptr,      nullptr},
+    {"PDF",  FileType::PDF,  hasSignature<PDFSignature>,  SIZE_MAX,            CostClass::Document, parsePDF,  parsePDFFile, nullptr},
+    {"ZIP",  FileType::ZIP,  hasSignature<ZIPSignature>,  SIZE_MAX,            CostClass::Archive,  parseZIP,  parseZIPFile, nullptr},
+    {"WAV",  FileType::WAV,  hasSignature<WAVSignature>,  sizeof(WAVHeader),   CostClass::Header,   parseWAV,  nullptr,      nullptr},
+    {"GIF",  FileType::GIF,  hasSignature<GIFSignature>,  GIFHeaderRegion,     CostClass::Header,   parseGIF,  nullptr,      hashImage<FileType::GIF>},
+    {"BMP",  FileType::BMP,  hasSignature<BMPSignature>,  BMPMaxHeaderRegion,  CostClass::Header,   parseBMP,  nullptr,      hashImage<FileType::BMP>},
+    {"PNG",  FileType::PNG,  hasSignature<PNGSignature>,  sizeof(PNGHeader),   CostClass::Header,   parsePNG,  nullptr,      hashImage<FileType::PNG>},
+    {"JPEG", FileType::JPEG, hasSignature<JPEGSignature>, JPEGMaxHeaderRegion, CostClass::Header,   parseJPEG, nullptr,      hashImage<FileType::JPEG>},
+};
+
+} // namespace
+
+std::span<const ExtractorDescriptor> builtinExtractors() {
+    return builtinTable;
+}
@@ -0,0 +1,1289 @@
+#include "PerceptualHash.h"
+#include "AsyncAnalyzer.h"
+#include "ExtractorRegistry.h"
+#include "MappedFile.h"
+#include <zlib.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <latch>
+#include <limits>
+#include <numbers>
+#include <numeric>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+
+constexpr std::size_t gridSize = 32;          // side of the thumbnail every decoder produces
+constexpr uint32_t maxDimension = 1u << 16;   // larger images are not decoded
+
+using Thumbnail = std::array<float, gridSize * gridSize>;
+
+inline float luma(uint8_t red, uint8_t green, uint8_t blue) {
+    return 0.299f * red + 0.587f * green + 0.114f * blue;
+}
+
+/**
+ * @brief out (m x p) = left (m x k) * src (k x n) * right (n x p), with m, n <= gridSize.
+ *
+ * The one kernel behind both resizing and the DCT. Each product keeps the innermost loop
+ * on contiguous rows without a reduction, so -O3 vectorizes it without -ffast-math.
+ */
+void separableTransform(const float* left, std::size_t m, std::size_t k, const float* src, std::size_t n,
+                        const float* right, std::size_t p, float* out) {
+    std::array<float, gridSize * gridSize> temp{};
+    for (std::size_t i = 0; i < m; ++i) {
+        float* __restrict t = &temp[i * n];
+        for (std::size_t r = 0; r < k; ++r) {
+            const float a = left[i * k + r];
+            const float* __restrict s = &src[r * n];
+            for (std::size_t j = 0; j < n; ++j) {
+                t[j] += a * s[j];
+            }
+        }
+    }
+
+    std::fill(out, out + m * p, 0.0f);
+    for (std::size_t i = 0; i < m; ++i) {
+        float* __restrict o = &out[i * p];
+        for (std::size_t j = 0; j < n; ++j) {
+            const float a = temp[i * n + j];
+            const float* __restrict r = &right[j * p];
+            for (std::size_t q = 0; q < p; ++q) {
+                o[q] += a * r[q];
+            }
+        }
+    }
+}
+
+/**
+ * @brief dst x src resampling matrix: box (area) weights when shrinking, linear when enlarging.
+ */
+std::vector<float> resizeWeights(std::size_t src, std::size_t dst) {
+    std::vector<float> weights(dst * src, 0.0f);
+    const double scale = static_cast<double>(src) / static_cast<double>(dst);
+    for (std::size_t i = 0; i < dst; ++i) {
+        if (dst <= src) {
+            const double begin = i * scale;
+            const double end = begin + scale;
+            for (std::size_t j = static_cast<std::size_t>(begin); j < src && j < end; ++j) {
+                const double overlap = std::min<double>(end, j + 1.0) - std::max<double>(begin, j);
+                weights[i * src + j] = static_cast<float>(overlap / scale);
+            }
+        } else {
+            const double center = std::clamp((i + 0.5) * scale - 0.5, 0.0, static_cast<double>(src - 1));
+            const std::size_t j = static_cast<std::size_t>(center);
+            const float fraction = static_cast<float>(center - j);
+            weights[i * src + j] += 1.0f - fraction;
+            weights[i * src + std::min(j + 1, src - 1)] += fraction;
+        }
+    }
+    return weights;
+}
+
+std::vector<float> transpose(const std::vector<float>& matrix, std::size_t rows, std::size_t columns) {
+    std::vector<float> result(matrix.size());
+    for (std::size_t r = 0; r < rows; ++r) {
+        for (std::size_t c = 0; c < columns; ++c) {
+            result[c * rows + r] = matrix[r * columns + c];
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Box-filters source rows into at most gridSize x gridSize cells as they are decoded,
+ * so no decoder ever holds more than a row of the image.
+ */
+class LumaGrid {
+public:
+    LumaGrid(uint32_t width, uint32_t height)
+        : height(height),
+          cellsX(std::min<uint32_t>(width, gridSize)),
+          cellsY(std::min<uint32_t>(height, gridSize)),
+          columnCell(width),
+          columnsInCell(cellsX, 0),
+          rowsInBand(cellsY, 0),
+          sums(static_cast<std::size_t>(cellsX) * cellsY, 0.0f) {
+        for (uint32_t x = 0; x < width; ++x) {
+            columnCell[x] = static_cast<uint32_t>(static_cast<uint64_t>(x) * cellsX / width);
+            ++columnsInCell[columnCell[x]];
+        }
+    }
+
+    // Adds source row y (width luma values); rows may arrive in any order
+    void addRow(uint32_t y, const float* row) {
+        const uint32_t band = static_cast<uint32_t>(static_cast<uint64_t>(y) * cellsY / height);
+        float* cells = &sums[static_cast<std::size_t>(band) * cellsX];
+        for (std::size_t x = 0; x < columnCell.size(); ++x) {
+            cells[columnCell[x]] += row[x];
+        }
+        ++rowsInBand[band];
+    }
+
+    // Cell averages resampled to gridSize x gridSize; nullopt if some band never received a row
+    std::optional<Thumbnail> finish() const {
+        std::vector<float> cells(sums.size());
+        for (uint32_t cy = 0; cy < cellsY; ++cy) {
+            if (rowsInBand[cy] == 0) {
+                return std::nullopt;
+            }
+            for (uint32_t cx = 0; cx < cellsX; ++cx) {
+                cells[cy * cellsX + cx] = sums[cy * cellsX + cx] / static_cast<float>(columnsInCell[cx] * rowsInBand[cy]);
+            }
+        }
+
+        Thumbnail thumbnail;
+        if (cellsX == gridSize && cellsY == gridSize) {
+            std::copy(cells.begin(), cells.end(), thumbnail.begin());
+        } else {
+            const std::vector<float> rows = resizeWeights(cellsY, gridSize);
+            const std::vector<float> columns = transpose(resizeWeights(cellsX, gridSize), gridSize, cellsX);
+            separableTransform(rows.data(), gridSize, cellsY, cells.data(), cellsX, columns.data(), gridSize, thumbnail.data());
+        }
+        return thumbnail;
+    }
+
+private:
+    uint32_t height;
+    uint32_t cellsX;
+    uint32_t cellsY;
+    std::vector<uint32_t> columnCell;
+    std::vector<uint32_t> columnsInCell;
+    std::vector<uint32_t> rowsInBand;
+    std::vector<float> sums;
+};
+
+/**
+ * @brief Matrices used to turn a thumbnail into hashes, built once.
+ */
+struct HashKernels {
+    std::vector<float> dHashRows;     // 8 x 32
+    std::vector<float> dHashColumns;  // 32 x 9
+    std::vector<float> dct;           // 8 x 32, lowest DCT-II basis vectors
+    std::vector<float> dctTransposed; // 32 x 8
+
+    HashKernels()
+        : dHashRows(resizeWeights(gridSize, 8)),
+          dHashColumns(transpose(resizeWeights(gridSize, 9), 9, gridSize)),
+          dct(8 * gridSize) {
+        for (std::size_t u = 0; u < 8; ++u) {
+            const double alpha = std::sqrt((u == 0 ? 1.0 : 2.0) / gridSize);
+            for (std::size_t x = 0; x < gridSize; ++x) {
+                dct[u * gridSize + x] = static_cast<float>(alpha * std::cos((2.0 * x + 1.0) * u * std::numbers::pi / (2.0 * gridSize)));
+            }
+        }
+        dctTransposed = transpose(dct, 8, gridSize);
+    }
+};
+
+PerceptualHash hashThumbnail(const Thumbnail& pixels) {
+    static const HashKernels kernels;
+    PerceptualHash hash{0, 0};
+
+    std::array<float, 8 * 9> small;
+    separableTransform(kernels.dHashRows.data(), 8, gridSize, pixels.data(), gridSize, kernels.dHashColumns.data(), 9, small.data());
+    for (std::size_t y = 0; y < 8; ++y) {
+        for (std::size_t x = 0; x < 8; ++x) {
+            if (small[y * 9 + x] > small[y * 9 + x + 1]) {
+                hash.dHash |= 1ull << (y * 8 + x);
+            }
+        }
+    }
+
+    std::array<float, 64> frequencies;
+    separableTransform(kernels.dct.data(), 8, gridSize, pixels.data(), gridSize, kernels.dctTransposed.data(), 8, frequencies.data());
+    // The DC term only reflects overall brightness, so it is left out of the median
+    std::array<float, 63> ac;
+    std::copy(frequencies.begin() + 1, frequencies.end(), ac.begin());
+    std::nth_element(ac.begin(), ac.begin() + 31, ac.end());
+    const float median = ac[31];
+    for (std::size_t i = 0; i < 64; ++i) {
+        if (frequencies[i] > median) {
+            hash.pHash |= 1ull << i;
+        }
+    }
+    return hash;
+}
+
+//Position and scale of one color channel inside a BMP bitfield pixel.
+struct BitfieldChannel {
+    uint32_t mask = 0;
+    int shift = 0;
+    float scale = 0.0f;
+
+    explicit BitfieldChannel(uint32_t mask) : mask(mask) {
+        if (mask) {
+            shift = std::countr_zero(mask);
+            scale = 255.0f / static_cast<float>(mask >> shift);
+        }
+    }
+
+    uint8_t operator()(uint32_t pixel) const {
+        return static_cast<uint8_t>(static_cast<float>((pixel & mask) >> shift) * scale + 0.5f);
+    }
+};
+
+/**
+ * @brief Uncompressed and bitfield BMPs at 1, 4, 8, 16, 24 and 32 bits per pixel.
+ */
+std::optional<Thumbnail> decodeBMP(std::span<const uint8_t> bytes) {
+    const BMPHeader header = parseBMPHeader(bytes);
+    const bool bitfields = header.compression == 3 || header.compression == 6;
+    const uint32_t bits = header.bitCount;
+    if ((header.compression != 0 && !bitfields) || (bitfields && bits != 16 && bits != 32)
+        || !(bits == 1 || bits == 4 || bits == 8 || bits == 16 || bits == 24 || bits == 32)) {
+        return std::nullopt;
+    }
+
+    const bool topDown = header.height < 0;
+    const int64_t signedHeight = header.height;
+    const uint32_t width = header.width > 0 ? static_cast<uint32_t>(header.width) : 0;
+    const uint32_t height = static_cast<uint32_t>(signedHeight < 0 ? -signedHeight : signedHeight);
+    if (width == 0 || height == 0 || width > maxDimension || height > maxDimension) {
+        return std::nullopt;
+    }
+
+    const std::size_t stride = ((static_cast<std::size_t>(width) * bits + 31) / 32) * 4;
+    if (header.dataOffset > bytes.size() || stride * height > bytes.size() - header.dataOffset) {
+        return std::nullopt;
+    }
+
+    std::array<float, 256> palette{};
+    const std::size_t entrySize = header.dibHeaderSize == 12 ? 3 : 4;
+    for (std::size_t i = 0; i < std::min<std::size_t>(header.paletteEntries, palette.size()); ++i) {
+        const std::size_t entry = header.paletteOffset + i * entrySize;
+        if (entry + 3 > bytes.size()) {
+            break;
+        }
+        palette[i] = luma(bytes[entry + 2], bytes[entry + 1], bytes[entry]);
+    }
+
+    const bool defaultMasks = !bitfields || (header.redMask | header.greenMask | header.blueMask) == 0;
+    const BitfieldChannel red(defaultMasks ? (bits == 16 ? 0x7C00u : 0xFF0000u) : header.redMask);
+    const BitfieldChannel green(defaultMasks ? (bits == 16 ? 0x03E0u : 0x00FF00u) : header.greenMask);
+    const BitfieldChannel blue(defaultMasks ? (bits == 16 ? 0x001Fu : 0x0000FFu) : header.blueMask);
+
+    LumaGrid grid(width, height);
+    std::vector<float> row(width);
+    for (uint32_t y = 0; y < height; ++y) {
+        const std::size_t line = header.dataOffset + y * stride;
+        for (uint32_t x = 0; x < width; ++x) {
+            switch (bits) {
+            case 1:
+            case 4:
+            case 8: {
+                const std::size_t bit = static_cast<std::size_t>(x) * bits;
+                const uint8_t index = static_cast<uint8_t>((bytes[line + bit / 8] >> (8 - bits - bit % 8)) & ((1u << bits) - 1));
+                row[x] = palette[index];
+                break;
+            }
+            case 16: {
+                const uint32_t pixel = readLE16(bytes, line + x * 2);
+                row[x] = luma(red(pixel), green(pixel), blue(pixel));
+                break;
+            }
+            case 24:
+                row[x] = luma(bytes[line + x * 3 + 2], bytes[line + x * 3 + 1], bytes[line + x * 3]);
+                break;
+            default: {
+                const uint32_t pixel = readLE32(bytes, line + x * 4);
+                row[x] = luma(red(pixel), green(pixel), blue(pixel));
+                break;
+            }
+            }
+        }
+        grid.addRow(topDown ? y : height - 1 - y, row.data());
+    }
+    return grid.finish();
+}
+
+/**
+ * @brief Reads LZW codes (least significant bit first) across a chain of GIF data sub-blocks.
+ */
+class SubBlockReader {
+public:
+    SubBlockReader(std::span<const uint8_t> bytes, std::size_t offset) : bytes(bytes), position(offset) {}
+
+    bool read(int size, uint32_t& code) {
+        while (bits < size) {
+            if (remaining == 0) {
+                if (position >= bytes.size() || bytes[position] == 0) {
+                    return false;
+                }
+                remaining = bytes[position++];
+            }
+            if (position >= bytes.size()) {
+                return false;
+            }
+            buffer |= static_cast<uint32_t>(bytes[position++]) << bits;
+            bits += 8;
+            --remaining;
+        }
+        code = buffer & ((1u << size) - 1);
+        buffer >>= size;
+        bits -= size;
+        return true;
+    }
+
+private:
+    std::span<const uint8_t> bytes;
+    std::size_t position;
+    std::size_t remaining = 0;
+    uint32_t buffer = 0;
+    int bits = 0;
+};
+
+// Row written by the n-th decoded line of an interlaced GIF frame
+uint32_t interlacedRow(uint32_t n, uint32_t height) {
+    const uint32_t pass1 = (height + 7) / 8;
+    if (n < pass1) {
+        return n * 8;
+    }
+    n -= pass1;
+    const uint32_t pass2 = (height + 3) / 8;
+    if (n < pass2) {
+        return 4 + n * 8;
+    }
+    n -= pass2;
+    const uint32_t pass3 = (height + 1) / 4;
+    if (n < pass3) {
+        return 2 + n * 4;
+    }
+    return 1 + (n - pass3) * 2;
+}
+
+void readGIFPalette(std::span<const uint8_t> bytes, std::size_t offset, std::size_t entries, std::array<float, 256>& palette) {
+    palette.fill(0.0f);
+    for (std::size_t i = 0; i < entries && offset + i * 3 + 3 <= bytes.size(); ++i) {
+        palette[i] = luma(bytes[offset + i * 3], bytes[offset + i * 3 + 1], bytes[offset + i * 3 + 2]);
+    }
+}
+
+/**
+ * @brief First frame of a GIF; the rest of the file is never touched.
+ */
+std::optional<Thumbnail> decodeGIF(std::span<const uint8_t> bytes) {
+    constexpr std::size_t screenEnd = sizeof(GIFHeader) + 7; // header + logical screen descriptor
+    if (bytes.size() < screenEnd) {
+        return std::nullopt;
+    }
+
+    std::array<float, 256> palette{};
+    std::size_t position = screenEnd;
+    const uint8_t screenFlags = bytes[sizeof(GIFHeader) + 4];
+    if (screenFlags & 0x80) {
+        const std::size_t entries = 1u << ((screenFlags & 7) + 1);
+        readGIFPalette(bytes, position, entries, palette);
+        position += entries * 3;
+    }
+
+    // Skip extensions up to the first image descriptor
+    while (position < bytes.size() && bytes[position] == 0x21) {
+        position += 2;
+        while (position < bytes.size() && bytes[position] != 0) {
+            position += bytes[position] + 1;
+        }
+        ++position;
+    }
+    if (position + 10 > bytes.size() || bytes[position] != 0x2C) {
+        return std::nullopt;
+    }
+
+    const uint32_t width = readLE16(bytes, position + 5);
+    const uint32_t height = readLE16(bytes, position + 7);
+    const uint8_t imageFlags = bytes[position + 9];
+    position += 10;
+    if (imageFlags & 0x80) {
+        const std::size_t entries = 1u << ((imageFlags & 7) + 1);
+        readGIFPalette(bytes, position, entries, palette);
+        position += entries * 3;
+    }
+    if (width == 0 || height == 0 || position >= bytes.size()) {
+        return std::nullopt;
+    }
+    const bool interlaced = imageFlags & 0x40;
+    const int minCodeSize = bytes[position++];
+    if (minCodeSize < 2 || minCodeSize > 8) {
+        return std::nullopt;
+    }
+
+    LumaGrid grid(width, height);
+    std::vector<float> row(width);
+    uint32_t column = 0;
+    uint32_t line = 0;
+    auto emit = [&](uint8_t index) {
+        row[column] = palette[index];
+        if (++column == width) {
+            grid.addRow(interlaced ? interlacedRow(line, height) : line, row.data());
+            column = 0;
+            ++line;
+        }
+    };
+
+    std::array<uint16_t, 4096> prefix{};
+    std::array<uint8_t, 4096> suffix{};
+    std::array<uint8_t, 4097> stack;
+    const uint32_t clearCode = 1u << minCodeSize;
+    const uint32_t endCode = clearCode + 1;
+    int codeSize = minCodeSize + 1;
+    uint32_t nextCode = clearCode + 2;
+    int32_t previous = -1;
+    uint8_t first = 0;
+
+    SubBlockReader reader(bytes, position);
+    uint32_t code;
+    while (line < height && reader.read(codeSize, code)) {
+        if (code == clearCode) {
+            codeSize = minCodeSize + 1;
+            nextCode = clearCode + 2;
+            previous = -1;
+            continue;
+        }
+        if (code == endCode) {
+            break;
+        }
+        if (previous < 0) {
+            if (code >= clearCode) {
+                return std::nullopt;
+            }
+            first = static_cast<uint8_t>(code);
+            emit(first);
+            previous = static_cast<int32_t>(code);
+            continue;
+        }
+
+        const uint32_t current = code;
+        std::size_t depth = 0;
+        if (code >= nextCode) {
+            if (code > nextCode) {
+                return std::nullopt;
+            }
+            stack[depth++] = first;
+            code = static_cast<uint32_t>(previous);
+        }
+        while (code >= clearCode) {
+            stack[depth++] = suffix[code];
+            code = prefix[code];
+        }
+        first = static_cast<uint8_t>(code);
+        stack[depth++] = first;
+        while (depth > 0 && line < height) {
+            emit(stack[--depth]);
+        }
+
+        if (nextCode < 4096) {
+            prefix[nextCode] = static_cast<uint16_t>(previous);
+            suffix[nextCode] = first;
+            if (++nextCode == (1u << codeSize) && codeSize < 12) {
+                ++codeSize;
+            }
+        }
+        previous = static_cast<int32_t>(current);
+    }
+
+    if (line < height) {
+        return std::nullopt;
+    }
+    return grid.finish();
+}
+
+// Sample x of a row packed at `depth` bits per sample (1, 2, 4 or 8)
+inline uint8_t packedSample(const uint8_t* line, uint32_t x, uint32_t depth) {
+    const std::size_t bit = static_cast<std::size_t>(x) * depth;
+    return static_cast<uint8_t>((line[bit / 8] >> (8 - depth - bit % 8)) & ((1u << depth) - 1));
+}
+
+/**
+ * @brief Non-interlaced PNGs of every color type, inflated and unfiltered one row at a time.
+ */
+std::optional<Thumbnail> decodePNG(std::span<const uint8_t> bytes) {
+    constexpr std::size_t ihdrEnd = 8 + 8 + 13;
+    if (bytes.size() < ihdrEnd || std::memcmp(bytes.data() + 12, "IHDR", 4) != 0) {
+        return std::nullopt;
+    }
+
+    const uint32_t width = readBE32(bytes, 16);
+    const uint32_t height = readBE32(bytes, 20);
+    const uint32_t depth = bytes[24];
+    const uint8_t colorType = bytes[25];
+    const bool interlaced = bytes[28] != 0;
+    if (width == 0 || height == 0 || width > maxDimension || height > maxDimension || interlaced) {
+        return std::nullopt;
+    }
+
+    uint32_t channels = 0;
+    switch (colorType) {
+    case 0: channels = 1; break;
+    case 2: channels = 3; break;
+    case 3: channels = 1; break;
+    case 4: channels = 2; break;
+    case 6: channels = 4; break;
+    default: return std::nullopt;
+    }
+    const bool depthValid = (colorType == 0 && (depth == 1 || depth == 2 || depth == 4 || depth == 8 || depth == 16))
+                         || (colorType == 3 && (depth == 1 || depth == 2 || depth == 4 || depth == 8))
+                         || ((colorType == 2 || colorType == 4 || colorType == 6) && (depth == 8 || depth == 16));
+    if (!depthValid) {
+        return std::nullopt;
+    }
+
+    const std::size_t bitsPerPixel = channels * depth;
+    const std::size_t rowBytes = (width * bitsPerPixel + 7) / 8;
+    const std::size_t filterStep = std::max<std::size_t>(1, bitsPerPixel / 8);
+    const std::size_t sampleBytes = depth == 16 ? 2 : 1; // 16-bit samples keep their high byte
+
+    std::vector<uint8_t> current(rowBytes + 1);
+    std::vector<uint8_t> previous(rowBytes, 0);
+    std::vector<float> row(width);
+    std::array<float, 256> palette{};
+    LumaGrid grid(width, height);
+    uint32_t line = 0;
+    std::size_t filled = 0;
+
+    auto finishRow = [&]() {
+        uint8_t* data = current.data() + 1;
+        const uint8_t* above = previous.data();
+        switch (current[0]) {
+        case 0:
+            break;
+        case 1:
+            for (std::size_t i = filterStep; i < rowBytes; ++i) {
+                data[i] = static_cast<uint8_t>(data[i] + data[i - filterStep]);
+            }
+            break;
+        case 2:
+            for (std::size_t i = 0; i < rowBytes; ++i) {
+                data[i] = static_cast<uint8_t>(data[i] + above[i]);
+            }
+            break;
+        case 3:
+            for (std::size_t i = 0; i < rowBytes; ++i) {
+                const int left = i >= filterStep ? data[i - filterStep] : 0;
+                data[i] = static_cast<uint8_t>(data[i] + ((left + above[i]) >> 1));
+            }
+            break;
+        case 4:
+            for (std::size_t i = 0; i < rowBytes; ++i) {
+                const int a = i >= filterStep ? data[i - filterStep] : 0;
+                const int b = above[i];
+                const int c = i >= filterStep ? above[i - filterStep] : 0;
+                const int p = a + b - c;
+                const int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+                data[i] = static_cast<uint8_t>(data[i] + (pa <= pb && pa <= pc ? a : pb <= pc ? b : c));
+            }
+            break;
+        default:
+            return false;
+        }
+
+        for (uint32_t x = 0; x < width; ++x) {
+            switch (colorType) {
+            case 0:
+                row[x] = depth >= 8 ? data[x * sampleBytes] : packedSample(data, x, depth) * (255.0f / static_cast<float>((1u << depth) - 1));
+                break;
+            case 3:
+                row[x] = palette[depth == 8 ? data[x] : packedSample(data, x, depth)];
+                break;
+            case 4:
+                row[x] = data[x * 2 * sampleBytes];
+                break;
+            default: {
+                const std::size_t pixel = static_cast<std::size_t>(x) * channels * sampleBytes;
+                row[x] = luma(data[pixel], data[pixel + sampleBytes], data[pixel + 2 * sampleBytes]);
+                break;
+            }
+            }
+        }
+        grid.addRow(line++, row.data());
+        std::copy(data, data + rowBytes, previous.begin());
+        return true;
+    };
+
+    z_stream stream{};
+    if (inflateInit(&stream) != Z_OK) {
+        return std::nullopt;
+    }
+    struct InflateGuard {
+        z_stream& stream;
+        ~InflateGuard() { inflateEnd(&stream); }
+    } guard{stream};
+
+    std::size_t position = 8;
+    bool streamEnded = false;
+    while (line < height && !streamEnded && position + 8 <= bytes.size()) {
+        const uint32_t length = readBE32(bytes, position);
+        const uint8_t* type = bytes.data() + position + 4;
+        const std::size_t data = position + 8;
+        if (length > bytes.size() - data) {
+            return std::nullopt;
+        }
+
+        if (std::memcmp(type, "PLTE", 4) == 0) {
+            for (std::size_t i = 0; i < std::min<std::size_t>(length / 3, palette.size()); ++i) {
+                palette[i] = luma(bytes[data + i * 3], bytes[data + i * 3 + 1], bytes[data + i * 3 + 2]);
+            }
+        } else if (std::memcmp(type, "IDAT", 4) == 0) {
+            stream.next_in = const_cast<Bytef*>(bytes.data() + data);
+            stream.avail_in = length;
+            while (line < height) {
+                stream.next_out = current.data() + filled;
+                stream.avail_out = static_cast<uInt>(current.size() - filled);
+                const int status = inflate(&stream, Z_NO_FLUSH);
+                filled = current.size() - stream.avail_out;
+                if (filled == current.size()) {
+                    if (!finishRow()) {
+                        return std::nullopt;
+                    }
+                    filled = 0;
+                }
+                if (status == Z_STREAM_END) {
+                    streamEnded = true;
+                    break;
+                }
+                if (status != Z_OK && status != Z_BUF_ERROR) {
+                    return std::nullopt;
+                }
+                if (stream.avail_in == 0 && stream.avail_out != 0) {
+                    break; // wants the next IDAT chunk
+                }
+            }
+        } else if (std::memcmp(type, "IEND", 4) == 0) {
+            break;
+        }
+        position = data + length + 4; // skip the CRC
+    }
+
+    if (line < height) {
+        return std::nullopt;
+    }
+    return grid.finish();
+}
+
+/**
+ * @brief Canonical Huffman table with an 8-bit lookahead for short codes.
+ */
+struct HuffmanTable {
+    std::array<uint8_t, 256> symbols{};
+    std::array<uint16_t, 256> fast{};     // (length << 8) | symbol for codes of up to 8 bits, 0 otherwise
+    std::array<int32_t, 17> maxCode{};    // largest code of each length, -1 if there is none
+    std::array<int32_t, 17> valueOffset{};
+    bool defined = false;
+
+    bool build(std::span<const uint8_t> counts, std::span<const uint8_t> values) {
+        fast.fill(0);
+        int32_t code = 0;
+        std::size_t index = 0;
+        for (int length = 1; length <= 16; ++length) {
+            valueOffset[length] = static_cast<int32_t>(index) - code;
+            for (uint8_t i = 0; i < counts[length - 1]; ++i, ++code, ++index) {
+                if (code >= (1 << length)) {
+                    return false;
+                }
+                symbols[index] = values[index];
+                if (length <= 8) {
+                    const int spread = 8 - length;
+                    for (int j = 0; j < (1 << spread); ++j) {
+                        fast[(code << spread) | j] = static_cast<uint16_t>((length << 8) | values[index]);
+                    }
+                }
+            }
+            maxCode[length] = counts[length - 1] ? code - 1 : -1;
+            code <<= 1;
+        }
+        defined = true;
+        return true;
+    }
+};
+
+/**
+ * @brief Bit reader over JPEG entropy-coded data that removes stuffed zero bytes and stops at markers.
+ */
+class EntropyReader {
+public:
+    EntropyReader(std::span<const uint8_t> bytes, std::size_t offset) : bytes(bytes), position(offset) {}
+
+    uint32_t peek16() {
+        fill();
+        return static_cast<uint32_t>(buffer >> 48);
+    }
+
+    void skip(int count) {
+        buffer <<= count;
+        bits -= count;
+    }
+
+    uint32_t receive(int count) {
+        fill();
+        const uint32_t value = static_cast<uint32_t>(buffer >> (64 - count));
+        skip(count);
+        return value;
+    }
+
+    // True once decoding has consumed zero padding past the end of the scan, i.e. the data is corrupt
+    bool overrun() const { return padding * 8 > bits; }
+
+    // Drops leftover bits and consumes the next RSTn marker
+    bool restart() {
+        buffer = 0;
+        bits = 0;
+        padding = 0;
+        atMarker = false;
+        while (position + 1 < bytes.size()) {
+            if (bytes[position] != 0xFF) {
+                ++position;
+                continue;
+            }
+            const uint8_t marker = bytes[position + 1];
+            if (marker >= 0xD0 && marker <= 0xD7) {
+                position += 2;
+                return true;
+            }
+            if (marker != 0x00 && marker != 0xFF) {
+                return false;
+            }
+            position += marker == 0x00 ? 2 : 1;
+        }
+        return false;
+    }
+
+private:
+    void fill() {
+        while (bits <= 48) {
+            uint64_t byte = 0;
+            if (!atMarker && position < bytes.size()) {
+                byte = bytes[position];
+                if (byte == 0xFF) {
+                    const uint8_t next = position + 1 < bytes.size() ? bytes[position + 1] : 0xD9;
+                    if (next == 0x00) {
+                        position += 2;
+                    } else {
+                        atMarker = true;
+                        byte = 0;
+                        ++padding;
+                    }
+                } else {
+                    ++position;
+                }
+            } else {
+                ++padding;
+            }
+            buffer |= byte << (56 - bits);
+            bits += 8;
+        }
+    }
+
+    std::span<const uint8_t> bytes;
+    std::size_t position;
+    uint64_t buffer = 0;
+    int bits = 0;
+    int padding = 0;
+    bool atMarker = false;
+};
+
+int decodeSymbol(EntropyReader& reader, const HuffmanTable& table) {
+    const uint32_t window = reader.peek16();
+    const uint16_t entry = table.fast[window >> 8];
+    if (entry) {
+        reader.skip(entry >> 8);
+        return entry & 0xFF;
+    }
+    for (int length = 9; length <= 16; ++length) {
+        const int32_t code = static_cast<int32_t>(window >> (16 - length));
+        if (code <= table.maxCode[length]) {
+            reader.skip(length);
+            return table.symbols[static_cast<std::size_t>(code + table.valueOffset[length]) & 0xFF];
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Decodes one 8x8 block, keeping only its DC coefficient; AC coefficients are skipped.
+ */
+bool decodeBlockDC(EntropyReader& reader, const HuffmanTable& dc, const HuffmanTable& ac, int& predictor) {
+    const int size = decodeSymbol(reader, dc);
+    if (size < 0 || size > 11) {
+        return false;
+    }
+    if (size > 0) {
+        int value = static_cast<int>(reader.receive(size));
+        if (value < (1 << (size - 1))) {
+            value -= (1 << size) - 1;
+        }
+        predictor += value;
+    }
+
+    for (int k = 1; k < 64;) {
+        const int symbol = decodeSymbol(reader, ac);
+        if (symbol < 0) {
+            return false;
+        }
+        const int run = symbol >> 4;
+        const int bits = symbol & 15;
+        if (bits == 0) {
+            if (run != 15) {
+                break; // end of block
+            }
+            k += 16;
+            continue;
+        }
+        reader.receive(bits);
+        k += run + 1;
+    }
+    return !reader.overrun();
+}
+
+struct JPEGComponent {
+    uint8_t id = 0;
+    uint8_t h = 1;
+    uint8_t v = 1;
+    uint8_t quantTable = 0;
+    uint8_t dcTable = 0;
+    uint8_t acTable = 0;
+    int predictor = 0;
+};
+
+/**
+ * @brief Baseline JPEGs at 1/8 scale: the luma DC coefficients form a thumbnail with one pixel per block.
+ */
+std::optional<Thumbnail> decodeJPEG(std::span<const uint8_t> bytes) {
+    std::array<HuffmanTable, 4> dcTables;
+    std::array<HuffmanTable, 4> acTables;
+    std::array<uint16_t, 4> dcQuant{1, 1, 1, 1};
+    std::vector<JPEGComponent> components;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t restartInterval = 0;
+
+    std::size_t position = 2;
+    while (position + 4 <= bytes.size()) {
+        if (bytes[position] != 0xFF) {
+            return std::nullopt;
+        }
+        const uint8_t marker = bytes[position + 1];
+        if (marker == 0xFF) {
+            ++position;
+            continue;
+        }
+        position += 2;
+        if (marker == 0xD8 || marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) {
+            continue;
+        }
+        if (marker == 0xD9) {
+            return std::nullopt;
+        }
+
+        const std::size_t length = readBE16(bytes, position);
+        if (length < 2 || length > bytes.size() - position) {
+            return std::nullopt;
+        }
+        const std::span<const uint8_t> segment = bytes.subspan(position + 2, length - 2);
+        position += length;
+
+        if (marker == 0xC0 || marker == 0xC1) {
+            if (segment.size() < 6 || segment[0] != 8) {
+                return std::nullopt;
+            }
+            height = readBE16(segment, 1);
+            width = readBE16(segment, 3);
+            const std::size_t count = segment[5];
+            if (count < 1 || count > 4 || segment.size() < 6 + count * 3 || width == 0 || height == 0) {
+                return std::nullopt;
+            }
+            components.resize(count);
+            for (std::size_t i = 0; i < count; ++i) {
+                components[i].id = segment[6 + i * 3];
+                components[i].h = segment[7 + i * 3] >> 4;
+                components[i].v = segment[7 + i * 3] & 15;
+                components[i].quantTable = segment[8 + i * 3] & 3;
+                if (components[i].h < 1 || components[i].h > 4 || components[i].v < 1 || components[i].v > 4) {
+                    return std::nullopt;
+                }
+            }
+        } else if ((marker >= 0xC2 && marker <= 0xCF) && marker != 0xC4 && marker != 0xC8 && marker != 0xCC) {
+            return std::nullopt; // progressive, lossless or arithmetic coded
+        } else if (marker == 0xC4) {
+            for (std::size_t offset = 0; offset + 17 <= segment.size();) {
+                const uint8_t tableClass = segment[offset] >> 4;
+                const uint8_t tableId = segment[offset] & 15;
+                const std::span<const uint8_t> counts = segment.subspan(offset + 1, 16);
+                const std::size_t total = std::accumulate(counts.begin(), counts.end(), std::size_t{0});
+                if (tableClass > 1 || tableId > 3 || total > 256 || offset + 17 + total > segment.size()) {
+                    return std::nullopt;
+                }
+                HuffmanTable& table = tableClass ? acTables[tableId] : dcTables[tableId];
+                if (!table.build(counts, segment.subspan(offset + 17, total))) {
+                    return std::nullopt;
+                }
+                offset += 17 + total;
+            }
+        } else if (marker == 0xDB) {
+            for (std::size_t offset = 0; offset < segment.size();) {
+                const bool wide = segment[offset] >> 4;
+                const uint8_t tableId = segment[offset] & 15;
+                const std::size_t tableSize = 1 + 64 * (wide ? 2 : 1);
+                if (tableId > 3 || offset + tableSize > segment.size()) {
+                    return std::nullopt;
+                }
+                dcQuant[tableId] = wide ? readBE16(segment, offset + 1) : segment[offset + 1];
+                offset += tableSize;
+            }
+        } else if (marker == 0xDD) {
+            if (segment.size() < 2) {
+                return std::nullopt;
+            }
+            restartInterval = readBE16(segment, 0);
+        } else if (marker == 0xDA) {
+            if (components.empty() || segment.empty() || segment.size() < 1 + segment[0] * 2u) {
+                return std::nullopt;
+            }
+
+            std::vector<JPEGComponent*> scan;
+            for (std::size_t i = 0; i < segment[0]; ++i) {
+                auto it = std::find_if(components.begin(), components.end(), [&](const JPEGComponent& c) { return c.id == segment[1 + i * 2]; });
+                if (it == components.end()) {
+                    return std::nullopt;
+                }
+                it->dcTable = segment[2 + i * 2] >> 4 & 3;
+                it->acTable = segment[2 + i * 2] & 3;
+                if (!dcTables[it->dcTable].defined || !acTables[it->acTable].defined) {
+                    return std::nullopt;
+                }
+                scan.push_back(&*it);
+            }
+
+            JPEGComponent& lumaComponent = components[0];
+            if (std::find(scan.begin(), scan.end(), &lumaComponent) == scan.end()) {
+                // A scan of chroma only; skip its entropy-coded data
+                while (position + 1 < bytes.size() && !(bytes[position] == 0xFF && bytes[position + 1] != 0x00
+                                                        && !(bytes[position + 1] >= 0xD0 && bytes[position + 1] <= 0xD7))) {
+                    ++position;
+                }
+                continue;
+            }
+
+            uint32_t maxH = 1, maxV = 1;
+            for (const JPEGComponent& component : components) {
+                maxH = std::max<uint32_t>(maxH, component.h);
+                maxV = std::max<uint32_t>(maxV, component.v);
+            }
+            const uint32_t blocksWide = ((width * lumaComponent.h + maxH - 1) / maxH + 7) / 8;
+            const uint32_t blocksHigh = ((height * lumaComponent.v + maxV - 1) / maxV + 7) / 8;
+            const float scale = dcQuant[lumaComponent.quantTable] / 8.0f;
+            auto level = [scale](int predictor) { return std::clamp(predictor * scale + 128.0f, 0.0f, 255.0f); };
+
+            LumaGrid grid(blocksWide, blocksHigh);
+            EntropyReader reader(bytes, position);
+            uint32_t mcusDone = 0;
+            auto nextMCU = [&]() {
+                if (restartInterval && mcusDone > 0 && mcusDone % restartInterval == 0) {
+                    if (!reader.restart()) {
+                        return false;
+                    }
+                    for (JPEGComponent* component : scan) {
+                        component->predictor = 0;
+                    }
+                }
+                ++mcusDone;
+                return true;
+            };
+
+            if (scan.size() == 1) {
+                // Non-interleaved: one block per MCU in raster order
+                std::vector<float> row(blocksWide);
+                for (uint32_t by = 0; by < blocksHigh; ++by) {
+                    for (uint32_t bx = 0; bx < blocksWide; ++bx) {
+                        if (!nextMCU() || !decodeBlockDC(reader, dcTables[lumaComponent.dcTable], acTables[lumaComponent.acTable], lumaComponent.predictor)) {
+                            return std::nullopt;
+                        }
+                        row[bx] = level(lumaComponent.predictor);
+                    }
+                    grid.addRow(by, row.data());
+                }
+                return grid.finish();
+            }
+
+            const uint32_t mcusWide = (width + 8 * maxH - 1) / (8 * maxH);
+            const uint32_t mcusHigh = (height + 8 * maxV - 1) / (8 * maxV);
+            const std::size_t bandWidth = static_cast<std::size_t>(mcusWide) * lumaComponent.h;
+            std::vector<float> band(bandWidth * lumaComponent.v);
+            for (uint32_t my = 0; my < mcusHigh; ++my) {
+                for (uint32_t mx = 0; mx < mcusWide; ++mx) {
+                    if (!nextMCU()) {
+                        return std::nullopt;
+                    }
+                    for (JPEGComponent* component : scan) {
+                        for (uint32_t v = 0; v < component->v; ++v) {
+                            for (uint32_t h = 0; h < component->h; ++h) {
+                                if (!decodeBlockDC(reader, dcTables[component->dcTable], acTables[component->acTable], component->predictor)) {
+                                    return std::nullopt;
+                                }
+                                if (component == &lumaComponent) {
+                                    band[v * bandWidth + mx * lumaComponent.h + h] = level(lumaComponent.predictor);
+                                }
+                            }
+                        }
+                    }
+                }
+                for (uint32_t v = 0; v < lumaComponent.v; ++v) {
+                    const uint32_t y = my * lumaComponent.v + v;
+                    if (y < blocksHigh) {
+                        grid.addRow(y, &band[v * bandWidth]);
+                    }
+                }
+            }
+            return grid.finish();
+        }
+    }
+    return std::nullopt;
+}
+
+/**
+ * @brief Multi-index hash table over 64-bit hashes for Hamming distance joins.
+ *
+ * The bits are split into `m` disjoint blocks, each bucketing all hashes by its value. Two
+ * hashes within r bits of each other differ in at most r / m bits of some block, so comparing
+ * every bucket with the buckets within that radius of it finds every such pair. `m` is picked
+ * from the number of hashes and the radius to balance probes against bucket size; when every
+ * choice costs more than comparing all pairs (large radii), there is a single bucket.
+ */
+class MultiIndexTable {
+public:
+    MultiIndexTable(std::span<const uint64_t> hashes, int maxDistance) : maxDistance(maxDistance) {
+        const unsigned blockCount = chooseBlockCount(hashes.size(), maxDistance);
+        blockRadius = blockCount > 0 ? maxDistance / static_cast<int>(blockCount) : 0;
+
+        unsigned shift = 0;
+        for (unsigned b = 0; b < std::max(blockCount, 1u); ++b) {
+            Block block;
+            block.shift = shift;
+            block.width = blockCount > 0 ? 64 / blockCount + (b < 64 % blockCount ? 1 : 0) : 0;
+            shift += block.width;
+
+            // Bucket the hashes by block value in one counting sort, keeping each next to its id
+            block.offsets.assign((std::size_t{1} << block.width) + 1, 0);
+            for (uint64_t hash : hashes) {
+                ++block.offsets[block.key(hash) + 1];
+            }
+            std::partial_sum(block.offsets.begin(), block.offsets.end(), block.offsets.begin());
+            block.entries.resize(hashes.size());
+            std::vector<uint32_t> fill(block.offsets.begin(), block.offsets.end() - 1);
+            for (std::size_t id = 0; id < hashes.size(); ++id) {
+                block.entries[fill[block.key(hashes[id])]++] = {hashes[id], static_cast<uint32_t>(id)};
+            }
+            for (uint32_t key = 0; key + 1 < block.offsets.size(); ++key) {
+                if (block.offsets[key] != block.offsets[key + 1]) {
+                    block.occupied.push_back(key);
+                }
+            }
+            blocks.push_back(std::move(block));
+        }
+    }
+
+    // Calls visit(i, j) with i < j for every pair of ids within maxDistance; a pair can come up once per block
+    template <typename Visit>
+    void forEachPair(Visit&& visit) const {
+        for (const Block& block : blocks) {
+            // One pass over the occupied buckets per bit flip pattern: the bucket and its partner
+            // are then both read in nearly ascending order, which prefetches well
+            forEachWithin(0, block.width, blockRadius, 0, [&](uint32_t flip) {
+                for (uint32_t key : block.occupied) {
+                    const uint32_t other = key ^ flip;
+                    // Each unordered pair of buckets once
+                    if (other < key) {
+                        continue;
+                    }
+                    for (const Entry& a : block.bucket(key)) {
+                        for (const Entry& b : block.bucket(other)) {
+                            if ((other != key || a.id < b.id) && hammingDistance(a.hash, b.hash) <= maxDistance) {
+                                visit(std::min(a.id, b.id), std::max(a.id, b.id));
+                            }
+                        }
+                    }
+                }
+            });
+        }
+    }
+
+private:
+    struct Entry {
+        uint64_t hash;
+        uint32_t id;
+    };
+
+    struct Block {
+        unsigned shift = 0;
+        unsigned width = 0;
+        std::vector<uint32_t> offsets; // bucket k holds entries[offsets[k], offsets[k + 1])
+        std::vector<Entry> entries;
+        std::vector<uint32_t> occupied; // keys of the non-empty buckets, ascending
+
+        uint32_t key(uint64_t hash) const { return width > 0 ? static_cast<uint32_t>((hash >> shift) & ((uint64_t{1} << width) - 1)) : 0; }
+        std::span<const Entry> bucket(uint32_t key) const {
+            return std::span<const Entry>(entries).subspan(offsets[key], offsets[key + 1] - offsets[key]);
+        }
+    };
+
+    // Widest block; the tables of all blocks together take m * 2^width offsets
+    static constexpr unsigned maxBlockWidth = 24;
+
+    // Calls visit for every value differing from `key` in at most `radius` of the bits at or above `from`
+    template <typename Visit>
+    static void forEachWithin(uint32_t key, unsigned width, int radius, unsigned from, Visit&& visit) {
+        visit(key);
+        if (radius == 0) {
+            return;
+        }
+        for (unsigned bit = from; bit < width; ++bit) {
+            forEachWithin(key ^ (uint32_t{1} << bit), width, radius - 1, bit + 1, visit);
+        }
+    }
+
+    // Block count minimizing the expected probes and comparisons for `count` hashes plus building
+    // the tables, or 0 if comparing all pairs is cheaper
+    static unsigned chooseBlockCount(std::size_t count, int maxDistance) {
+        const double n = static_cast<double>(count);
+        unsigned best = 0;
+        double bestCost = n * n / 2;
+        for (unsigned m = (64 + maxBlockWidth - 1) / maxBlockWidth; m <= 64; ++m) {
+            const unsigned width = (64 + m - 1) / m;
+            const int radius = std::min(maxDistance / static_cast<int>(m), static_cast<int>(width));
+            double probes = 0;
+            double ways = 1;
+            for (int k = 0; k <= radius; ++k) {
+                probes += ways;
+                ways = ways * (width - k) / (k + 1);
+            }
+            const double buckets = std::ldexp(1.0, static_cast<int>(width));
+            const double occupied = std::min(n, buckets);
+            const double cost = m * (occupied * probes + n * n * probes / buckets / 2 + buckets);
+            if (cost < bestCost) {
+                best = m;
+                bestCost = cost;
+            }
+        }
+        return best;
+    }
+
+    int maxDistance;
+    int blockRadius = 0;
+    std::vector<Block> blocks;
+};
+
+} // namespace
+
+std::string formatHash(uint64_t hash) {
+    static constexpr char digits[] = "0123456789abcdef";
+    std::string text(16, '0');
+    for (int i = 15; i >= 0; --i, hash >>= 4) {
+        text[i] = digits[hash & 15];
+    }
+    return text;
+}
+
+std::optional<PerceptualHash> computePerceptualHash(FileType type, std::span<const uint8_t> bytes) {
+    try {
+        std::optional<Thumbnail> thumbnail;
+        switch (type) {
+        case FileType::BMP:  thumbnail = decodeBMP(bytes); break;
+        case FileType::GIF:  thumbnail = decodeGIF(bytes); break;
+        case FileType::PNG:  thumbnail = decodePNG(bytes); break;
+        case FileType::JPEG: thumbnail = decodeJPEG(bytes); break;
+        default: return std::nullopt;
+        }
+        if (!thumbnail) {
+            return std::nullopt;
+        }
+        return hashThumbnail(*thumbnail);
+    } catch (const std::exception&) {
+        return std::nullopt;
+    }
+}
+
+std::optional<PerceptualHash> computePerceptualHash(const std::filesystem::path& filePath) {
+    const MappedFile mapping(filePath, MADV_SEQUENTIAL);
+    const ExtractorDescriptor* extractor = ExtractorRegistry::instance().sniff(mapping.bytes());
+    if (!extractor) {
+        return std::nullopt;
+    }
+    return computePerceptualHash(extractor->type, mapping.bytes());
+}
+
+std::vector<HashedImage> hashImages(const std::vector<std::filesystem::path>& roots) {
+    std::vector<std::filesystem::path> files;
+    for (const auto& root : roots) {
+        std::error_code ec;
+        if (std::filesystem::is_directory(root, ec)) {
+            for (auto it = std::filesystem::recursive_directory_iterator(root, std::filesystem::directory_options::skip_permission_denied, ec);
+                 !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+                if (it->is_regular_file(ec)) {
+                    files.push_back(it->path());
+                }
+            }
+        } else if (std::filesystem::is_regular_file(root, ec)) {
+            files.push_back(root);
+        }
+    }
+
+    // Decoding is CPU bound; every I/O thread pulls files until none are left
+    std::vector<std::optional<PerceptualHash>> hashes(files.size());
+    const std::size_t workers = std::max(1u, std::thread::hardware_concurrency());
+    std::atomic<std::size_t> next{0};
+    std::latch done(static_cast<std::ptrdiff_t>(workers));
+    for (std::size_t w = 0; w < workers; ++w) {
+        defaultAsyncContext().io->post([&] {
+            for (std::size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < files.size();) {
+                hashes[i] = computePerceptualHash(files[i]);
+            }
+            done.count_down();
+        });
+    }
+    done.wait();
+
+    std::vector<HashedImage> images;
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        if (hashes[i]) {
+            images.push_back({files[i].string(), *hashes[i]});
+        }
+    }
+    return images;
+}
+
+std::vector<std::vector<std::size_t>> groupNearDuplicates(const std::vector<HashedImage>& images, int maxDistance) {
+    if (maxDistance < 0) {
+        return {};
+    }
+    std::vector<uint64_t> hashes(images.size());
+    for (std::size_t i = 0; i < images.size(); ++i) {
+        hashes[i] = images[i].hash.pHash;
+    }
+    const MultiIndexTable table(hashes, maxDistance);
+
+    std::vector<std::size_t> parent(images.size());
+    std::iota(parent.begin(), parent.end(), std::size_t{0});
+    auto root = [&parent](std::size_t i) {
+        while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    };
+
+    table.forEachPair([&](uint32_t i, uint32_t j) { parent[root(j)] = root(i); });
+
+    std::unordered_map<std::size_t, std::size_t> groupOf;
+    std::vector<std::vector<std::size_t>> groups;
+    for (std::size_t i = 0; i < images.size(); ++i) {
+        auto [it, inserted] = groupOf.try_emplace(root(i), groups.size());
+        if (inserted) {
+            groups.emplace_back();
+        }
+        groups[it->second].push_back(i);
+    }
+    std::erase_if(groups, [](const std::vector<std::size_t>& group) { return group.size() < 2; });
+    return groups;
+}
@@ -0,0 +1,335 @@
+#include "TreeSampler.h"
+#include "AsyncAnalyzer.h"
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <map>
+#include <random>
+#include <semaphore>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+// Layout of struct linux_dirent64: d_ino (8), d_off (8), d_reclen (2), d_type (1), d_name
+constexpr std::size_t direntReclenOffset = 16;
+constexpr std::size_t direntTypeOffset = 18;
+constexpr std::size_t direntNameOffset = 19;
+constexpr std::size_t direntBufferSize = 64 * 1024;
+
+// Two-sided 95% normal quantile
+constexpr double confidenceZ = 1.959964;
+
+std::string joinPath(std::string_view directory, std::string_view name) {
+    std::string path;
+    path.reserve(directory.size() + 1 + name.size());
+    path.append(directory);
+    if (path.empty() || path.back() != '/') {
+        path.push_back('/');
+    }
+    path.append(name);
+    return path;
+}
+
+// Resolves DT_UNKNOWN (some file systems never fill in d_type) without following links
+unsigned char statType(int directoryFd, const char* name) {
+    struct stat info;
+    if (fstatat(directoryFd, name, &info, AT_SYMLINK_NOFOLLOW) != 0) {
+        return DT_UNKNOWN;
+    }
+    if (S_ISDIR(info.st_mode)) {
+        return DT_DIR;
+    }
+    return S_ISREG(info.st_mode) ? DT_REG : DT_UNKNOWN;
+}
+
+/**
+ * @brief Calls `onFile(directory, name)` for every regular file below `root`.
+ *
+ * Reads each directory in large getdents64 batches and trusts `d_type`, so files are
+ * never stat'ed unless the file system leaves the type unknown. Unreadable directories
+ * are skipped.
+ */
+template <typename OnFile>
+void enumerateFiles(const std::filesystem::path& root, OnFile&& onFile) {
+    std::error_code ec;
+    if (!std::filesystem::is_directory(root, ec)) {
+        if (std::filesystem::is_regular_file(root, ec)) {
+            onFile(root.parent_path().string(), root.filename().string());
+        }
+        return;
+    }
+
+    std::vector<std::string> pending{root.string()};
+    std::vector<char> buffer(direntBufferSize);
+    while (!pending.empty()) {
+        const std::string directory = std::move(pending.back());
+        pending.pop_back();
+
+        const int fd = open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd < 0) {
+            continue;
+        }
+        for (;;) {
+            const long length = syscall(SYS_getdents64, fd, buffer.data(), buffer.size());
+            if (length <= 0) {
+                break;
+            }
+            for (long offset = 0; offset < length;) {
+                const char* entry = buffer.data() + offset;
+                uint16_t recordLength;
+                std::memcpy(&recordLength, entry + direntReclenOffset, sizeof(recordLength));
+                offset += recordLength;
+
+                const char* name = entry + direntNameOffset;
+                if (std::strcmp(name, ".") == 0 || std::strcmp(name, "..") == 0) {
+                    continue;
+                }
+                unsigned char type = static_cast<unsigned char>(entry[direntTypeOffset]);
+                if (type == DT_UNKNOWN) {
+                    type = statType(fd, name);
+                }
+
+                if (type == DT_DIR) {
+                    pending.push_back(joinPath(directory, name));
+                } else if (type == DT_REG) {
+                    onFile(std::string_view(directory), std::string_view(name));
+                }
+            }
+        }
+        close(fd);
+    }
+}
+
+/**
+ * @brief Picks files as they are enumerated, building a path only for the ones it keeps.
+ *
+ * Both modes jump straight to the next file to keep instead of drawing a random number
+ * per file: geometric gaps for Bernoulli sampling and Li's Algorithm L for the reservoir.
+ */
+class FileSampler {
+public:
+    explicit FileSampler(const SampleSpec& spec) : spec(spec), rng(std::random_device{}()) {
+        if (spec.mode == SampleMode::Rate) {
+            advance();
+        }
+    }
+
+    void offer(std::string_view directory, std::string_view name) {
+        ++seen;
+        if (spec.mode == SampleMode::Count && picks.size() < spec.count) {
+            picks.push_back(joinPath(directory, name));
+            if (picks.size() == spec.count) {
+                advance();
+            }
+        } else if (seen == nextPick) {
+            if (spec.mode == SampleMode::Count) {
+                picks[std::uniform_int_distribution<std::uint64_t>(0, spec.count - 1)(rng)] = joinPath(directory, name);
+            } else {
+                picks.push_back(joinPath(directory, name));
+            }
+            advance();
+        }
+    }
+
+    std::uint64_t population() const { return seen; }
+    std::vector<std::string>& sample() { return picks; }
+
+private:
+    // Uniform in the open interval (0, 1)
+    double unit() {
+        double u;
+        do {
+            u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        } while (u == 0.0);
+        return u;
+    }
+
+    void advance() {
+        double keep = spec.rate;
+        if (spec.mode == SampleMode::Count) {
+            weight *= std::exp(std::log(unit()) / static_cast<double>(spec.count));
+            keep = weight;
+        }
+        if (keep >= 1.0) {
+            nextPick = seen + 1;
+            return;
+        }
+        const double gap = std::floor(std::log(unit()) / std::log1p(-keep));
+        nextPick = gap >= 1e18 ? UINT64_MAX : seen + static_cast<std::uint64_t>(gap) + 1;
+    }
+
+    SampleSpec spec;
+    std::mt19937_64 rng;
+    std::vector<std::string> picks;
+    std::uint64_t seen = 0;
+    std::uint64_t nextPick = 0;
+    double weight = 1.0;
+};
+
+detached_task analyzeSample(async_generator<MetadataRecord> records, std::map<std::string, TypeEstimate>* byType, std::binary_semaphore* done) {
+    while (auto record = co_await records.next()) {
+        const std::string fileType = record->fileType.empty() ? "UNKNOWN" : record->fileType;
+        TypeEstimate& estimate = (*byType)[fileType];
+        estimate.fileType = fileType;
+        ++estimate.sampled;
+
+        std::error_code ec;
+        const std::uint64_t size = std::filesystem::file_size(record->path, ec);
+        if (!ec) {
+            estimate.sampledBytes += size;
+            ++estimate.sizeHistogram[std::bit_width(size)];
+        }
+    }
+    done->release();
+}
+
+/**
+ * @brief Wilson score interval for a proportion, narrowed by the finite population
+ * correction since files are sampled without replacement.
+ */
+void confidenceInterval(TypeEstimate& estimate, std::uint64_t sampled, std::uint64_t population) {
+    const double n = static_cast<double>(sampled);
+    const double p = static_cast<double>(estimate.sampled) / n;
+    estimate.fraction = p;
+    if (sampled >= population) {
+        estimate.low = estimate.high = p;
+        return;
+    }
+
+    const double effectiveN = n * (static_cast<double>(population) - 1.0) / static_cast<double>(population - sampled);
+    const double z2 = confidenceZ * confidenceZ;
+    const double denominator = 1.0 + z2 / effectiveN;
+    const double center = (p + z2 / (2.0 * effectiveN)) / denominator;
+    const double halfWidth = confidenceZ * std::sqrt(p * (1.0 - p) / effectiveN + z2 / (4.0 * effectiveN * effectiveN)) / denominator;
+    estimate.low = std::max(0.0, center - halfWidth);
+    estimate.high = std::min(1.0, center + halfWidth);
+}
+
+std::string formatBytes(double bytes) {
+    static constexpr const char* units[] = {"B", "KiB", "MiB", "GiB", "TiB", "PiB", "EiB"};
+    std::size_t unit = 0;
+    while (bytes >= 1024.0 && unit + 1 < std::size(units)) {
+        bytes /= 1024.0;
+        ++unit;
+    }
+    std::ostringstream text;
+    text << std::fixed << std::setprecision(unit == 0 ? 0 : 1) << bytes << ' ' << units[unit];
+    return text.str();
+}
+
+std::string percent(double fraction) {
+    std::ostringstream text;
+    text << std::fixed << std::setprecision(2) << fraction * 100.0 << '%';
+    return text.str();
+}
+
+// Interval label such as "[1.0 KiB, 2.0 KiB)" or "[38.21%, 44.26%]"
+std::string interval(const std::string& low, const std::string& high, char close) {
+    std::ostringstream text;
+    text << '[' << low << ", " << high << close;
+    return text.str();
+}
+
+} // namespace
+
+SampleSpec parseSampleSpec(std::string_view text) {
+    SampleSpec spec;
+    const bool isPercent = text.ends_with('%');
+    if (isPercent) {
+        text.remove_suffix(1);
+    }
+
+    if (isPercent || text.find_first_of(".eE") != std::string_view::npos) {
+        double rate = 0;
+        const auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), rate);
+        if (ec != std::errc() || end != text.data() + text.size()) {
+            throw std::invalid_argument("Invalid sample rate: " + std::string(text));
+        }
+        rate = isPercent ? rate / 100.0 : rate;
+        if (!(rate > 0.0 && rate <= 1.0)) {
+            throw std::invalid_argument("Sample rate must be in (0, 1] or (0%, 100%]");
+        }
+        spec.mode = SampleMode::Rate;
+        spec.rate = rate;
+        return spec;
+    }
+
+    const auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), spec.count);
+    if (ec != std::errc() || end != text.data() + text.size() || spec.count == 0) {
+        throw std::invalid_argument("Invalid sample size: " + std::string(text));
+    }
+    spec.mode = SampleMode::Count;
+    return spec;
+}
+
+SampleSummary sampleTree(const std::vector<std::filesystem::path>& roots, const SampleSpec& spec) {
+    FileSampler sampler(spec);
+    for (const auto& root : roots) {
+        enumerateFiles(root, [&sampler](std::string_view directory, std::string_view name) {
+            sampler.offer(directory, name);
+        });
+    }
+
+    SampleSummary summary;
+    summary.population = sampler.population();
+    summary.sampled = sampler.sample().size();
+    if (summary.sampled == 0) {
+        return summary;
+    }
+
+    std::map<std::string, TypeEstimate> byType;
+    std::binary_semaphore done(0);
+    analyzeSample(analyze_many(std::move(sampler.sample())), &byType, &done);
+    done.acquire();
+
+    for (auto& [fileType, estimate] : byType) {
+        confidenceInterval(estimate, summary.sampled, summary.population);
+        summary.types.push_back(std::move(estimate));
+    }
+    std::sort(summary.types.begin(), summary.types.end(), [](const TypeEstimate& a, const TypeEstimate& b) {
+        return a.sampled > b.sampled;
+    });
+    return summary;
+}
+
+void printSampleSummary(std::ostream& out, const SampleSummary& summary) {
+    out << "Sampled " << summary.sampled << " of " << summary.population << " files";
+    if (summary.population > 0) {
+        out << " (" << percent(static_cast<double>(summary.sampled) / static_cast<double>(summary.population)) << ")";
+    }
+    out << std::endl;
+    if (summary.sampled == 0) {
+        return;
+    }
+
+    const double scale = static_cast<double>(summary.population) / static_cast<double>(summary.sampled);
+    out << std::endl << std::left << std::setw(10) << "FileType" << std::right
+        << std::setw(10) << "Sampled" << std::setw(10) << "Fraction" << "   " << std::left << std::setw(20) << "95% CI" << std::right
+        << std::setw(14) << "Est. files" << std::setw(14) << "Est. size" << std::endl;
+
+    for (const TypeEstimate& estimate : summary.types) {
+        out << std::left << std::setw(10) << estimate.fileType << std::right
+            << std::setw(10) << estimate.sampled << std::setw(10) << percent(estimate.fraction) << "   " << std::left
+            << std::setw(20) << interval(percent(estimate.low), percent(estimate.high), ']') << std::right
+            << std::setw(14) << static_cast<std::uint64_t>(std::llround(estimate.fraction * static_cast<double>(summary.population)))
+            << std::setw(14) << formatBytes(static_cast<double>(estimate.sampledBytes) * scale) << std::endl;
+
+        for (std::size_t bucket = 0; bucket < estimate.sizeHistogram.size(); ++bucket) {
+            if (estimate.sizeHistogram[bucket] == 0) {
+                continue;
+            }
+            const std::string range = bucket == 0 ? "0 B"
+                : interval(formatBytes(std::ldexp(1.0, static_cast<int>(bucket) - 1)), formatBytes(std::ldexp(1.0, static_cast<int>(bucket))), ')');
+            out << "    " << std::left << std::setw(24) << range << std::right << std::setw(10) << estimate.sizeHistogram[bucket] << std::endl;
+        }
+    }
+}
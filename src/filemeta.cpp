@@ -0,0 +1,319 @@
+#include "filemeta.h"
+#include "AsyncAnalyzer.h"
+#include "ExtractorRegistry.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <deque>
+#include <new>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+/**
+ * @brief Owns the strings an fma_result points into.
+ */
+struct ResultStorage {
+    std::string path;
+    std::string fileType;
+    std::string error;
+    CustomMap<std::string, std::string> metadata;
+    std::vector<fma_entry> entries;
+    fma_status status = FMA_OK;
+
+    // Never throws, so it can be called from the C entry points' error paths
+    fma_status publish(fma_result* out) noexcept {
+        entries.clear();
+        try {
+            for (const auto& pair : metadata) {
+                entries.push_back({pair.key.c_str(), pair.value.c_str()});
+            }
+        } catch (const std::bad_alloc&) {
+            entries.clear();
+            fail(FMA_ERROR_PARSE, "Out of memory");
+        }
+        out->path = path.c_str();
+        out->file_type = fileType.empty() ? nullptr : fileType.c_str();
+        out->entries = entries.data();
+        out->entry_count = entries.size();
+        out->status = status;
+        out->error = status == FMA_OK ? nullptr : error.c_str();
+        return status;
+    }
+
+    void fail(fma_status failure, const char* message) noexcept {
+        status = failure;
+        try {
+            error = message;
+        } catch (const std::bad_alloc&) {
+            error.clear();
+        }
+    }
+};
+
+struct CachedResult {
+    std::uintmax_t size;
+    std::filesystem::file_time_type mtime;
+    std::string fileType;
+    CustomMap<std::string, std::string> metadata;
+};
+
+// Size of the first fma_session_options layout; later versions only append fields
+constexpr std::size_t firstOptionsSize = offsetof(fma_session_options, cache_entries) + sizeof(size_t);
+
+fma_status statusOf(AnalysisStatus status) {
+    switch (status) {
+        case AnalysisStatus::Ok:          return FMA_OK;
+        case AnalysisStatus::ReadFailed:  return FMA_ERROR_IO;
+        case AnalysisStatus::Unsupported: return FMA_ERROR_UNSUPPORTED;
+        case AnalysisStatus::ParseFailed: return FMA_ERROR_PARSE;
+    }
+    return FMA_ERROR_PARSE;
+}
+
+detached_task reportAll(async_generator<MetadataRecord> records, fma_result_callback callback, void* userData, std::binary_semaphore* done) {
+    ResultStorage storage;
+    while (auto record = co_await records.next()) {
+        storage.path = record->path.string();
+        storage.fileType = std::move(record->fileType);
+        storage.metadata = std::move(record->metadata);
+        storage.status = statusOf(record->status);
+        storage.error = std::move(record->error);
+
+        fma_result result;
+        storage.publish(&result);
+        callback(&result, userData);
+    }
+    done->release();
+}
+
+} // namespace
+
+struct fma_session {
+    fma_session_options options;
+
+    // Reused for every file so steady-state analysis does not allocate read buffers
+    std::vector<uint8_t> bytes;
+    ResultStorage result;
+
+    // Failure message of the most recent call, for fma_session_last_error
+    std::string lastError;
+    bool failed = false;
+
+    void succeed() noexcept {
+        failed = false;
+    }
+
+    fma_status fail(fma_status failure, const char* message) noexcept {
+        failed = true;
+        try {
+            lastError = message;
+        } catch (const std::bad_alloc&) {
+            lastError.clear();
+        }
+        return failure;
+    }
+
+    // Mirrors a published result, so fma_session_last_error also covers fma_analyze*
+    fma_status report(fma_status status) noexcept {
+        return status == FMA_OK ? (succeed(), status) : fail(status, result.error.c_str());
+    }
+
+    // Started on the first fma_analyze_many call
+    std::optional<ThreadPool> io;
+    std::optional<ThreadPool> blocking;
+
+    std::unordered_map<std::string, CachedResult> cache;
+    std::deque<std::string> cacheOrder; // oldest first
+
+    void remember(const std::filesystem::path& filePath, std::uintmax_t size, std::filesystem::file_time_type mtime) {
+        if (options.cache_entries == 0) {
+            return;
+        }
+        const std::string key = filePath.string();
+        auto [entry, inserted] = cache.insert_or_assign(key, CachedResult{size, mtime, result.fileType, result.metadata});
+        if (inserted) {
+            cacheOrder.push_back(key);
+        }
+        if (cache.size() > options.cache_entries) {
+            cache.erase(cacheOrder.front());
+            cacheOrder.pop_front();
+        }
+    }
+};
+
+extern "C" {
+
+fma_session* fma_session_create(const fma_session_options* options) {
+    if (options && (options->size < firstOptionsSize || options->size > sizeof(fma_session_options))) {
+        return nullptr;
+    }
+    fma_session* session = new (std::nothrow) fma_session();
+    if (!session) {
+        return nullptr;
+    }
+    // Fields a caller's (older) layout does not include keep their defaults
+    session->options = fma_session_options{sizeof(fma_session_options), 0, 0, 0};
+    if (options) {
+        std::memcpy(&session->options, options, options->size);
+        session->options.size = sizeof(fma_session_options);
+    }
+    if (session->options.io_threads == 0) {
+        session->options.io_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (session->options.blocking_threads == 0) {
+        session->options.blocking_threads = 2;
+    }
+    return session;
+}
+
+void fma_session_destroy(fma_session* session) {
+    delete session;
+}
+
+const char* fma_session_last_error(const fma_session* session) {
+    return session && session->failed ? session->lastError.c_str() : nullptr;
+}
+
+fma_status fma_load_plugin(fma_session* session, const char* pluginPath) {
+    if (!session) {
+        return FMA_ERROR_INVALID_ARGUMENT;
+    }
+    if (!pluginPath) {
+        return session->fail(FMA_ERROR_INVALID_ARGUMENT, "plugin_path is NULL");
+    }
+    try {
+        ExtractorRegistry::instance().loadPlugin(pluginPath);
+    } catch (const std::exception& e) {
+        return session->fail(FMA_ERROR_PLUGIN, e.what());
+    }
+    session->succeed();
+    return FMA_OK;
+}
+
+fma_status fma_analyze(fma_session* session, const char* path, fma_result* out) {
+    if (!session) {
+        return FMA_ERROR_INVALID_ARGUMENT;
+    }
+    if (!path || !out) {
+        return session->fail(FMA_ERROR_INVALID_ARGUMENT, "path and out must not be NULL");
+    }
+
+    const ExtractorRegistry& registry = ExtractorRegistry::instance();
+    ResultStorage& result = session->result;
+    result.fileType.clear();
+    result.metadata = {};
+    result.status = FMA_OK;
+
+    try {
+        result.path = path;
+        const std::filesystem::path filePath(path);
+
+        // Size and mtime are only needed to key the cache; skip both stats without one
+        std::uintmax_t size = 0;
+        std::filesystem::file_time_type mtime{};
+        bool stamped = false;
+        if (session->options.cache_entries > 0) {
+            std::error_code ec;
+            size = std::filesystem::file_size(filePath, ec);
+            if (!ec) {
+                mtime = std::filesystem::last_write_time(filePath, ec);
+            }
+            stamped = !ec;
+        }
+
+        if (stamped) {
+            auto cached = session->cache.find(result.path);
+            if (cached != session->cache.end() && cached->second.size == size && cached->second.mtime == mtime) {
+                result.fileType = cached->second.fileType;
+                result.metadata = cached->second.metadata;
+                return session->report(result.publish(out));
+            }
+        }
+
+        const std::size_t prefetched = registry.prefetchSize();
+        if (!readFilePrefix(filePath, prefetched, session->bytes)) {
+            result.fail(FMA_ERROR_IO, ("Cannot open " + result.path).c_str());
+            return session->report(result.publish(out));
+        }
+        const ExtractorDescriptor* extractor = registry.sniff(session->bytes);
+        if (!extractor) {
+            result.fail(FMA_ERROR_UNSUPPORTED, unsupportedFormatMessage);
+            return session->report(result.publish(out));
+        }
+
+        result.fileType = extractor->name;
+        result.metadata = registry.extract(*extractor, filePath, session->bytes, prefetched);
+        if (stamped) {
+            session->remember(filePath, size, mtime);
+        }
+    } catch (const std::exception& e) {
+        result.fail(FMA_ERROR_PARSE, e.what());
+    }
+    return session->report(result.publish(out));
+}
+
+fma_status fma_analyze_buffer(fma_session* session, const void* bytes, size_t length, const char* name, fma_result* out) {
+    if (!session) {
+        return FMA_ERROR_INVALID_ARGUMENT;
+    }
+    if ((!bytes && length > 0) || !out) {
+        return session->fail(FMA_ERROR_INVALID_ARGUMENT, "bytes (when length > 0) and out must not be NULL");
+    }
+
+    const ExtractorRegistry& registry = ExtractorRegistry::instance();
+    const std::span<const uint8_t> data(static_cast<const uint8_t*>(bytes), length);
+    ResultStorage& result = session->result;
+    result.fileType.clear();
+    result.metadata = {};
+    result.status = FMA_OK;
+
+    try {
+        result.path = name ? name : "";
+        const ExtractorDescriptor* extractor = registry.sniff(data);
+        if (!extractor) {
+            result.fail(FMA_ERROR_UNSUPPORTED, unsupportedFormatMessage);
+            return session->report(result.publish(out));
+        }
+        result.fileType = extractor->name;
+        result.metadata = extractor->parse(data, result.path);
+    } catch (const std::exception& e) {
+        result.fail(FMA_ERROR_PARSE, e.what());
+    }
+    return session->report(result.publish(out));
+}
+
+fma_status fma_analyze_many(fma_session* session, const char* const* paths, size_t count,
+                            fma_result_callback callback, void* userData) {
+    if (!session) {
+        return FMA_ERROR_INVALID_ARGUMENT;
+    }
+    if ((!paths && count > 0) || !callback) {
+        return session->fail(FMA_ERROR_INVALID_ARGUMENT, "paths (when count > 0) and callback must not be NULL");
+    }
+    // std::filesystem::path cannot be built from a null pointer
+    if (std::find(paths, paths + count, nullptr) != paths + count) {
+        return session->fail(FMA_ERROR_INVALID_ARGUMENT, "paths contains a NULL element");
+    }
+
+    try {
+        if (!session->io) {
+            session->io.emplace(session->options.io_threads);
+            session->blocking.emplace(session->options.blocking_threads);
+        }
+
+        std::vector<std::filesystem::path> files(paths, paths + count);
+        std::binary_semaphore done(0);
+        reportAll(analyze_many(std::move(files), AsyncContext{&*session->io, &*session->blocking}), callback, userData, &done);
+        done.acquire();
+    } catch (const std::exception& e) {
+        return session->fail(FMA_ERROR_IO, e.what());
+    }
+    session->succeed();
+    return FMA_OK;
+}
+
+} // extern "C"
@@ -1,6 +1,13 @@
 #include "FileMetaDataAnalyzer.h"
+#include "ArchiveAnalyzer.h"
+#include "ColumnarIndex.h"
+#include "ExtractorRegistry.h"
+#include "TreeSampler.h"
+#include "PerceptualHash.h"
 #include <iostream>
 #include <iomanip>
+#include <chrono>
+#include <charconv>
 #include <poppler/cpp/poppler-document.h>
 #include <poppler/cpp/poppler-page.h>
 
@@ -26,20 +33,193 @@ void mergeMap(CustomMap<std::string, std::string>& dest, const CustomMap<std::st
         }
     }
 
+/**
+ * @brief `index <index_file> <path>...` : analyzes files/directories into a columnar index.
+ */
+int runIndexCommand(int argc, char* argv[]) {
+    if (argc < 4) {
+        std::cerr << "Usage: " << argv[0] << " index <index_file> <path>..." << std::endl;
+        return 1;
+    }
+
+    std::vector<std::filesystem::path> roots;
+    for (int i = 3; i < argc; ++i) {
+        if (!std::string(argv[i]).starts_with("--")) {
+            roots.emplace_back(argv[i]);
+        }
+    }
+    try {
+        std::vector<IndexRow> rows = collectIndexRows(roots);
+        writeIndex(argv[2], rows);
+        std::cout << "Indexed " << rows.size() << " files into " << argv[2] << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief `query <index_file> [--count] <predicate>...` : prints the files matching every predicate.
+ */
+int runQueryCommand(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " query <index_file> [--count] <predicate>..." << std::endl;
+        std::cerr << "Predicates: type=PNG width>4000 height<=100 size>=10M mtime>-7d" << std::endl;
+        return 1;
+    }
+
+    try {
+        bool countOnly = false;
+        std::vector<QueryPredicate> predicates;
+        for (int i = 3; i < argc; ++i) {
+            if (std::string(argv[i]) == "--count") {
+                countOnly = true;
+            } else if (!std::string(argv[i]).starts_with("--")) {
+                predicates.push_back(parsePredicate(argv[i]));
+            }
+        }
+
+        ColumnarIndex index(argv[2]);
+        const auto start = std::chrono::steady_clock::now();
+        const std::vector<uint32_t> matches = index.query(predicates);
+        const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+
+        if (!countOnly) {
+            for (uint32_t row : matches) {
+                std::cout << index.path(row) << std::endl;
+            }
+        }
+        std::cout << matches.size() << " of " << index.rowCount() << " files matched in "
+                  << std::fixed << std::setprecision(3) << elapsed.count() << " ms" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief `--sample=<rate|count> <path>...` : estimates the FileType mix of the trees from a random sample.
+ */
+int runSampleCommand(int argc, char* argv[], std::string_view specText) {
+    try {
+        const SampleSpec spec = parseSampleSpec(specText);
+        std::vector<std::filesystem::path> roots;
+        for (int i = 1; i < argc; ++i) {
+            if (!std::string(argv[i]).starts_with("--")) {
+                roots.emplace_back(argv[i]);
+            }
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        const SampleSummary summary = sampleTree(roots, spec);
+        const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+
+        printSampleSummary(std::cout, summary);
+        std::cout << std::endl << "Done in " << std::fixed << std::setprecision(2) << elapsed.count() << " s" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief `--find-duplicates[=<bits>] <path>...` : groups images whose pHashes differ in at most `bits` bits.
+ */
+int runDuplicatesCommand(int argc, char* argv[], std::string_view distanceText) {
+    int maxDistance = 8;
+    if (!distanceText.empty()) {
+        const auto [end, ec] = std::from_chars(distanceText.data(), distanceText.data() + distanceText.size(), maxDistance);
+        if (ec != std::errc() || end != distanceText.data() + distanceText.size() || maxDistance < 0 || maxDistance > 64) {
+            std::cerr << "Invalid Hamming distance: " << distanceText << " (expected 0-64)" << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<std::filesystem::path> roots;
+    for (int i = 1; i < argc; ++i) {
+        if (!std::string(argv[i]).starts_with("--")) {
+            roots.emplace_back(argv[i]);
+        }
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const std::vector<HashedImage> images = hashImages(roots);
+    const auto hashed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+    const std::vector<std::vector<std::size_t>> groups = groupNearDuplicates(images, maxDistance);
+
+    for (std::size_t g = 0; g < groups.size(); ++g) {
+        std::cout << "Group " << g + 1 << " (" << groups[g].size() << " images):" << std::endl;
+        for (std::size_t i : groups[g]) {
+            std::cout << "  " << formatHash(images[i].hash.pHash) << "  " << images[i].path << std::endl;
+        }
+    }
+    std::cout << "Hashed " << images.size() << " images in " << std::fixed << std::setprecision(2) << hashed.count() << " s ("
+              << std::setprecision(0) << (hashed.count() > 0 ? images.size() / hashed.count() : 0.0) << " images/s), "
+              << groups.size() << " groups within " << maxDistance << " bits" << std::endl;
+    return 0;
+}
+
 int main(int argc, char* argv[]) {
     if (argc < 2) {
-        std::cerr << "Usage: " << argv[0] << " <file_path>" << std::endl;
+        std::cerr << "Usage: " << argv[0] << " [--descend-archives] [--phash] [--plugin=<lib.so>]... <file_path>" << std::endl;
+        std::cerr << "       " << argv[0] << " index <index_file> <path>..." << std::endl;
+        std::cerr << "       " << argv[0] << " query <index_file> [--count] <predicate>..." << std::endl;
+        std::cerr << "       " << argv[0] << " --sample=<rate|count> <path>..." << std::endl;
+        std::cerr << "       " << argv[0] << " --find-duplicates[=<bits>] <path>..." << std::endl;
         return 1;
     }
+
+    // Plugins go first so that every subcommand sees their formats
     for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg.starts_with("--plugin=")) {
+            try {
+                ExtractorRegistry::instance().loadPlugin(arg.substr(std::string("--plugin=").size()));
+            } catch (const std::exception& e) {
+                std::cerr << e.what() << std::endl;
+                return 1;
+            }
+        }
+    }
 
+    if (std::string(argv[1]) == "index") {
+        return runIndexCommand(argc, argv);
+    }
+    if (std::string(argv[1]) == "query") {
+        return runQueryCommand(argc, argv);
+    }
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg.starts_with("--sample=")) {
+            return runSampleCommand(argc, argv, std::string_view(argv[i]).substr(std::string("--sample=").size()));
+        }
+        if (arg == "--find-duplicates" || arg.starts_with("--find-duplicates=")) {
+            return runDuplicatesCommand(argc, argv, std::string_view(argv[i]).substr(std::min(arg.size(), std::string("--find-duplicates=").size())));
+        }
+    }
+
+    bool descendArchives = false;
+    bool perceptualHash = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--descend-archives") {
+            descendArchives = true;
+        } else if (std::string(argv[i]) == "--phash") {
+            perceptualHash = true;
+        }
+    }
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]).starts_with("--")) {
+            continue;
+        }
 
         std::filesystem::path filePath = argv[i];
         CustomMap<std::string, std::string> metadata;
 
-        // Determine file type based on file signature
-        FileType fileType = determineFileType<poppler::document, std::ifstream, JPEGHeader, PNGHeader, BMPHeader, ZIPHeader, WAVHeader,GIFHeader>(filePath);
-
         std::cout <<"For "<<argv[i]<< " Select metadata extraction option:" << std::endl;
         std::cout << "1. Basic Metadata" << std::endl;
         std::cout << "2. Specialized Metadata" << std::endl;
@@ -49,53 +229,18 @@ int main(int argc, char* argv[]) {
         std::cin >> choice;
 
         if(choice == 1 || choice == 3){
-            metadata = FileMetaDataAnalyzer<BasicMetadata>::analyzeMetadata(filePath);
+            metadata = analyzeBasicMetadata(filePath);
         }
-        try{
 
-            
+        // Extractor matched by the file signature
+        const ExtractorDescriptor* extractor = nullptr;
+        try{
             if(choice == 2 || choice == 3){
-                // Analyze metadata based on file type
-                switch (fileType) {
-                    case FileType::PDF:
-                            mergeMap(metadata, FileMetaDataAnalyzer<poppler::document>::analyzeMetadata(filePath));
-                            std::cout << "PDF Metadata:" << std::endl;
-                        metadata = FileMetaDataAnalyzer<poppler::document>::analyzeMetadata(filePath);
-                        std::cout << "PDF Metadata:" << std::endl;
-                        break;
-                    case FileType::TXT:
-                        mergeMap(metadata,FileMetaDataAnalyzer<std::ifstream>::analyzeMetadata(filePath));
-                        std::cout << "TXT Metadata:" << std::endl;
-                        break;
-                    case FileType::JPEG:
-                        mergeMap(metadata, FileMetaDataAnalyzer<JPEGHeader>::analyzeMetadata(filePath));
-                        std::cout << "JPEG Metadata:" << std::endl;
-                        break;
-                    case FileType::PNG:
-                        mergeMap(metadata, FileMetaDataAnalyzer<PNGHeader>::analyzeMetadata(filePath));
-                        std::cout << "PNG Metadata:" << std::endl;
-                        break;
-                    case FileType::BMP:
-                        mergeMap(metadata, FileMetaDataAnalyzer<BMPHeader>::analyzeMetadata(filePath));
-                        std::cout << "BMP Metadata:" << std::endl;
-                        break;
-                    case FileType::ZIP:
-                        mergeMap(metadata, FileMetaDataAnalyzer<ZIPHeader>::analyzeMetadata(filePath));
-                        std::cout << "ZIP Metadata:" << std::endl;
-                        break;
-                    case FileType::WAV:
-                        mergeMap(metadata, FileMetaDataAnalyzer<WAVHeader>::analyzeMetadata(filePath));
-                        std::cout << "WAV Metadata:" << std::endl;
-                        break;
-
-                    case FileType::GIF:
-                        mergeMap(metadata, FileMetaDataAnalyzer<GIFHeader,LogicalScreenDescriptor>::analyzeMetadata(filePath));
-                        std::cout << "GIF Metadata:" << std::endl;
-                        break;
-                    default:
-                        std::cerr << "Unsupported file format." << std::endl;
-                        return 1;
-                }
+                // Image extractors hash a mapping of the file in the same call
+                Extraction extraction = ExtractorRegistry::instance().analyze(filePath, perceptualHash);
+                extractor = extraction.extractor;
+                mergeMap(metadata, extraction.metadata);
+                std::cout << extractor->name << " Metadata:" << std::endl;
             }
         }catch (const std::exception& e) {
             std::cerr << e.what() << std::endl;
@@ -104,6 +249,13 @@ int main(int argc, char* argv[]) {
 
         // Print the extracted metadata using a lambda template
         printMetadata(metadata);
+
+        if (descendArchives && extractor && extractor->type == FileType::ZIP) {
+            for (const auto& member : analyzeArchiveMembers(filePath)) {
+                std::cout << "Member " << member.path << ":" << std::endl;
+                printMetadata(member.metadata);
+            }
+        }
     }
     return 0;
 }
\ No newline at end of file
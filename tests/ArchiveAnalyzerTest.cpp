@@ -0,0 +1,224 @@
+#include "ArchiveAnalyzer.h"
+#include <zlib.h>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const std::string& what) {
+    if (!condition) {
+        std::cerr << "FAILED: " << what << std::endl;
+        ++failures;
+    }
+}
+
+std::vector<uint8_t> readSample(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), {});
+}
+
+/**
+ * @brief Writes small ZIP archives byte by byte, so tests control every header field.
+ *
+ * Members are written with the given method and flags but never actually compressed or
+ * encrypted; that is enough for the central directory to describe them. With `zip64`, the
+ * sizes, offsets and entry count are saturated in the classic fields and stored in ZIP64
+ * extra fields and a ZIP64 end of central directory record.
+ */
+class ZipBuilder {
+public:
+    explicit ZipBuilder(bool zip64 = false) : zip64(zip64) {}
+
+    void add(const std::string& name, const std::vector<uint8_t>& data, uint16_t method = 0, uint16_t flags = 0) {
+        const uint32_t crc = static_cast<uint32_t>(crc32(0, data.data(), static_cast<uInt>(data.size())));
+        const uint64_t localHeader = archive.size();
+
+        put32(archive, 0x04034b50);
+        put16(archive, 45);
+        put16(archive, flags);
+        put16(archive, method);
+        put32(archive, 0); // time and date
+        put32(archive, crc);
+        put32(archive, static_cast<uint32_t>(data.size()));
+        put32(archive, static_cast<uint32_t>(data.size()));
+        put16(archive, static_cast<uint16_t>(name.size()));
+        put16(archive, 0);
+        archive.insert(archive.end(), name.begin(), name.end());
+        archive.insert(archive.end(), data.begin(), data.end());
+
+        std::vector<uint8_t> extra;
+        if (zip64) {
+            put16(extra, 0x0001);
+            put16(extra, 24);
+            put64(extra, data.size());
+            put64(extra, data.size());
+            put64(extra, localHeader);
+        }
+        const uint32_t saturated = 0xFFFFFFFF;
+        put32(central, 0x02014b50);
+        put16(central, 45);
+        put16(central, 45);
+        put16(central, flags);
+        put16(central, method);
+        put32(central, 0);
+        put32(central, crc);
+        put32(central, zip64 ? saturated : static_cast<uint32_t>(data.size()));
+        put32(central, zip64 ? saturated : static_cast<uint32_t>(data.size()));
+        put16(central, static_cast<uint16_t>(name.size()));
+        put16(central, static_cast<uint16_t>(extra.size()));
+        put16(central, 0); // comment
+        put16(central, 0); // disk
+        put16(central, 0); // internal attributes
+        put32(central, 0); // external attributes
+        put32(central, zip64 ? saturated : static_cast<uint32_t>(localHeader));
+        central.insert(central.end(), name.begin(), name.end());
+        central.insert(central.end(), extra.begin(), extra.end());
+        ++entries;
+    }
+
+    std::vector<uint8_t> finish() const {
+        std::vector<uint8_t> bytes = archive;
+        const uint64_t centralOffset = bytes.size();
+        bytes.insert(bytes.end(), central.begin(), central.end());
+
+        if (zip64) {
+            const uint64_t record = bytes.size();
+            put32(bytes, 0x06064b50);
+            put64(bytes, 44); // size of the rest of the record
+            put16(bytes, 45);
+            put16(bytes, 45);
+            put32(bytes, 0);
+            put32(bytes, 0);
+            put64(bytes, entries);
+            put64(bytes, entries);
+            put64(bytes, central.size());
+            put64(bytes, centralOffset);
+
+            put32(bytes, 0x07064b50);
+            put32(bytes, 0);
+            put64(bytes, record);
+            put32(bytes, 1);
+        }
+
+        put32(bytes, 0x06054b50);
+        put16(bytes, 0);
+        put16(bytes, 0);
+        put16(bytes, zip64 ? 0xFFFF : static_cast<uint16_t>(entries));
+        put16(bytes, zip64 ? 0xFFFF : static_cast<uint16_t>(entries));
+        put32(bytes, zip64 ? 0xFFFFFFFF : static_cast<uint32_t>(central.size()));
+        put32(bytes, zip64 ? 0xFFFFFFFF : static_cast<uint32_t>(centralOffset));
+        put16(bytes, 0);
+        return bytes;
+    }
+
+private:
+    static void put16(std::vector<uint8_t>& out, uint16_t value) {
+        out.push_back(static_cast<uint8_t>(value));
+        out.push_back(static_cast<uint8_t>(value >> 8));
+    }
+    static void put32(std::vector<uint8_t>& out, uint32_t value) {
+        put16(out, static_cast<uint16_t>(value));
+        put16(out, static_cast<uint16_t>(value >> 16));
+    }
+    static void put64(std::vector<uint8_t>& out, uint64_t value) {
+        put32(out, static_cast<uint32_t>(value));
+        put32(out, static_cast<uint32_t>(value >> 32));
+    }
+
+    bool zip64;
+    uint64_t entries = 0;
+    std::vector<uint8_t> archive;
+    std::vector<uint8_t> central;
+};
+
+const ArchiveMemberRecord* findMember(const std::vector<ArchiveMemberRecord>& records, const std::string& path) {
+    for (const ArchiveMemberRecord& record : records) {
+        if (record.path == path) {
+            return &record;
+        }
+    }
+    return nullptr;
+}
+
+std::string value(const ArchiveMemberRecord* record, const std::string& key) {
+    if (!record) {
+        return {};
+    }
+    for (const auto& [name, text] : record->metadata) {
+        if (name == key) {
+            return text;
+        }
+    }
+    return {};
+}
+
+void storedMembersAreParsedInPlace() {
+    ZipBuilder zip;
+    zip.add("image.png", readSample("samples/1.png"));
+    zip.add("notes.txt", {'h', 'e', 'l', 'l', 'o'});
+    const std::vector<uint8_t> archive = zip.finish();
+
+    const auto records = analyzeArchiveMembers(archive, "test.zip");
+    const ArchiveMemberRecord* image = findMember(records, "test.zip/image.png");
+    check(records.size() == 2, "both members are listed");
+    check(value(image, "FileType") == "PNG", "a stored PNG member is identified");
+    check(value(image, "ZeroCopy") == "yes", "a stored member is parsed straight from the archive bytes");
+}
+
+void unreadableMembersAreSkipped() {
+    ZipBuilder zip;
+    zip.add("secret.png", readSample("samples/1.png"), 0, 0x1); // traditional PKWARE encryption
+    zip.add("big.bin", {1, 2, 3, 4}, 9);                        // Deflate64, which libzip does not implement
+    zip.add("plain.txt", {'o', 'k'});
+    const std::vector<uint8_t> archive = zip.finish();
+
+    const auto records = analyzeArchiveMembers(archive, "test.zip");
+    for (const std::string name : {"secret.png", "big.bin"}) {
+        const ArchiveMemberRecord* member = findMember(records, "test.zip/" + name);
+        check(member != nullptr, name + " is listed");
+        check(value(member, "Skipped").starts_with("cannot open member: "), name + " reports why it could not be opened");
+        check(value(member, "FileType").empty(), name + " is not reported as a parsed file");
+        check(value(member, "FileName") == name, name + " still carries its central directory fields");
+    }
+    check(value(findMember(records, "test.zip/plain.txt"), "FileType") == "TXT", "members after an unreadable one are still analyzed");
+}
+
+void zip64ArchivesAreFollowed() {
+    const std::vector<uint8_t> png = readSample("samples/1.png");
+    ZipBuilder zip(true);
+    zip.add("a.txt", {'h', 'e', 'l', 'l', 'o'});
+    zip.add("b.png", png);
+    const std::vector<uint8_t> archive = zip.finish();
+
+    const auto records = analyzeArchiveMembers(archive, "test.zip");
+    const ArchiveMemberRecord* image = findMember(records, "test.zip/b.png");
+    check(records.size() == 2, "members are found through the ZIP64 end of central directory record");
+    check(value(image, "FileType") == "PNG", "a member located by its ZIP64 extra field is identified");
+    check(value(image, "ZeroCopy") == "yes", "ZIP64 sizes and offsets are used to find stored data");
+    check(value(image, "FileSize") == std::to_string(png.size()) + " bytes", "the ZIP64 size is reported");
+}
+
+} // namespace
+
+/**
+ * @brief Archive member walker tests on archives built in memory. Run from the repository
+ * root (uses samples/).
+ */
+int main() {
+    storedMembersAreParsedInPlace();
+    unreadableMembersAreSkipped();
+    zip64ArchivesAreFollowed();
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "All archive analyzer tests passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,187 @@
+#include "AsyncAnalyzer.h"
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const std::string& what) {
+    if (!condition) {
+        std::cerr << "FAILED: " << what << std::endl;
+        ++failures;
+    }
+}
+
+/**
+ * @brief Executor that only runs work when the test drains it, so interleavings are deterministic.
+ */
+class ManualExecutor : public Executor {
+public:
+    void post(std::function<void()> work) override { queue.push_back(std::move(work)); }
+
+    bool runOne() {
+        if (queue.empty()) {
+            return false;
+        }
+        std::function<void()> work = std::move(queue.front());
+        queue.pop_front();
+        work();
+        return true;
+    }
+
+    std::size_t drain() {
+        std::size_t ran = 0;
+        while (runOne()) {
+            ++ran;
+        }
+        return ran;
+    }
+
+private:
+    std::deque<std::function<void()>> queue;
+};
+
+/**
+ * @brief Eagerly started coroutine whose frame the test owns, so it can be destroyed while suspended.
+ */
+struct owned_coroutine {
+    struct promise_type {
+        owned_coroutine get_return_object() { return owned_coroutine(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    explicit owned_coroutine(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+    owned_coroutine(const owned_coroutine&) = delete;
+    owned_coroutine& operator=(const owned_coroutine&) = delete;
+    ~owned_coroutine() { handle.destroy(); }
+
+    bool done() const { return handle.done(); }
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+owned_coroutine consumeAll(async_generator<MetadataRecord>& records, std::vector<MetadataRecord>* seen) {
+    while (auto record = co_await records.next()) {
+        seen->push_back(std::move(*record));
+    }
+}
+
+task<int> answer(bool* started) {
+    *started = true;
+    co_return 42;
+}
+
+task<int> failing() {
+    throw std::runtime_error("task failed");
+    co_return 0;
+}
+
+void taskIsLazyAndFreedUnawaited() {
+    bool started = false;
+    {
+        task<int> work = answer(&started);
+    }
+    check(!started, "a task that is never awaited does not run");
+
+    check(sync_wait(answer(&started)) == 42 && started, "sync_wait returns the task's value");
+
+    bool threw = false;
+    try {
+        sync_wait(failing());
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    check(threw, "sync_wait rethrows the task's exception");
+}
+
+void generatorDestroyedWhileWaiting() {
+    ManualExecutor io;
+    ManualExecutor blocking;
+    std::vector<MetadataRecord> seen;
+    {
+        auto records = analyze_many(std::vector<std::filesystem::path>{"samples/1.png", "samples/sample.txt"}, AsyncContext{&io, &blocking});
+        // Starts both files and suspends the producer in its completion queue
+        owned_coroutine consumer = consumeAll(records, &seen);
+        check(!consumer.done(), "the consumer waits until a file completes");
+    }
+    // The files complete after both frames are gone; nothing may resume them
+    io.drain();
+    blocking.drain();
+    check(seen.empty(), "records of a destroyed generator are dropped");
+}
+
+void generatorDestroyedAfterFirstRecord() {
+    ManualExecutor io;
+    ManualExecutor blocking;
+    std::vector<MetadataRecord> seen;
+    {
+        auto records = analyze_many(std::vector<std::filesystem::path>{"samples/1.png", "samples/1.bmp", "samples/sample.txt"}, AsyncContext{&io, &blocking}, 1);
+        owned_coroutine consumer = consumeAll(records, &seen);
+        while (seen.empty() && io.runOne()) {
+        }
+    }
+    io.drain();
+    blocking.drain();
+    check(seen.size() == 1, "a consumer destroyed after one record sees only that record");
+}
+
+void consumerResumedOnIoExecutor() {
+    ManualExecutor io;
+    ManualExecutor blocking;
+    std::vector<MetadataRecord> seen;
+
+    auto records = analyze_many(std::vector<std::filesystem::path>{"samples/demo.zip"}, AsyncContext{&io, &blocking});
+    owned_coroutine consumer = consumeAll(records, &seen);
+
+    io.drain();       // identifies the archive and hands it to the blocking executor
+    blocking.drain(); // extracts it and completes the task
+    check(seen.empty(), "completing on the blocking executor does not resume the consumer there");
+
+    io.drain();
+    check(seen.size() == 1 && seen[0].fileType == "ZIP", "the consumer is resumed on the io executor");
+    check(consumer.done(), "the generator finishes after its last record");
+}
+
+void statusReportsFailureKind() {
+    ManualExecutor io;
+    ManualExecutor blocking;
+    std::vector<MetadataRecord> seen;
+
+    auto records = analyze_many(std::vector<std::filesystem::path>{"samples/does-not-exist"}, AsyncContext{&io, &blocking});
+    owned_coroutine consumer = consumeAll(records, &seen);
+    while (io.drain() + blocking.drain() > 0) {
+    }
+    check(seen.size() == 1 && seen[0].status == AnalysisStatus::ReadFailed, "a missing file is reported as ReadFailed");
+}
+
+} // namespace
+
+/**
+ * @brief Lifetime tests for the coroutine API: lazy tasks, generators destroyed early and
+ * the executor consumers are resumed on. Run from the repository root (uses samples/).
+ */
+int main() {
+    taskIsLazyAndFreedUnawaited();
+    generatorDestroyedWhileWaiting();
+    generatorDestroyedAfterFirstRecord();
+    consumerResumedOnIoExecutor();
+    statusReportsFailureKind();
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "All async analyzer tests passed" << std::endl;
+    return 0;
+}
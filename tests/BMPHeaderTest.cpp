@@ -0,0 +1,229 @@
+#include "ExtractorRegistry.h"
+#include "FileMetaDataAnalyzer.h"
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const std::string& what) {
+    if (!condition) {
+        std::cerr << "FAILED: " << what << std::endl;
+        ++failures;
+    }
+}
+
+std::vector<uint8_t> readSample(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), {});
+}
+
+void put16(std::vector<uint8_t>& out, std::size_t offset, uint16_t value) {
+    out[offset] = static_cast<uint8_t>(value);
+    out[offset + 1] = static_cast<uint8_t>(value >> 8);
+}
+
+void put32(std::vector<uint8_t>& out, std::size_t offset, uint32_t value) {
+    put16(out, offset, static_cast<uint16_t>(value));
+    put16(out, offset + 2, static_cast<uint16_t>(value >> 16));
+}
+
+/**
+ * @brief Builds a BMP file header followed by a zeroed DIB header of the given size.
+ *
+ * Offsets passed to put16/put32 on the result are from the start of the file, so DIB
+ * header fields are at `BMPFileHeaderSize + <offset in the DIB header>`.
+ */
+std::vector<uint8_t> bmp(uint32_t dibSize, uint32_t dataOffset, std::size_t trailingBytes = 0) {
+    std::vector<uint8_t> bytes(BMPFileHeaderSize + dibSize + trailingBytes);
+    bytes[0] = 'B';
+    bytes[1] = 'M';
+    put32(bytes, 2, static_cast<uint32_t>(bytes.size()));
+    put32(bytes, 10, dataOffset);
+    put32(bytes, 14, dibSize);
+    return bytes;
+}
+
+// Width, height, planes and bit count of every DIB header other than BITMAPCOREHEADER
+std::vector<uint8_t> infoBmp(uint32_t dibSize, int32_t width, int32_t height, uint16_t bitCount, uint32_t dataOffset,
+                             std::size_t trailingBytes = 0) {
+    std::vector<uint8_t> bytes = bmp(dibSize, dataOffset, trailingBytes);
+    const std::size_t dib = BMPFileHeaderSize;
+    put32(bytes, dib + 4, static_cast<uint32_t>(width));
+    put32(bytes, dib + 8, static_cast<uint32_t>(height));
+    put16(bytes, dib + 12, 1);
+    put16(bytes, dib + 14, bitCount);
+    return bytes;
+}
+
+std::string value(const CustomMap<std::string, std::string>& metadata, const std::string& key) {
+    for (const auto& [name, text] : metadata) {
+        if (name == key) {
+            return text;
+        }
+    }
+    return {};
+}
+
+bool throws(const std::vector<uint8_t>& bytes) {
+    try {
+        parseBMPHeader(bytes);
+    } catch (const std::runtime_error&) {
+        return true;
+    }
+    return false;
+}
+
+void coreHeaderHasUnsigned16BitDimensions() {
+    const std::size_t dib = BMPFileHeaderSize;
+    // 8-bit indexed, with room for only 10 of the 256 RGB triples before the pixel data
+    std::vector<uint8_t> bytes = bmp(12, BMPFileHeaderSize + 12 + 10 * 3);
+    put16(bytes, dib + 4, 300);
+    put16(bytes, dib + 6, 40000);
+    put16(bytes, dib + 8, 1);
+    put16(bytes, dib + 10, 8);
+
+    const BMPHeader header = parseBMPHeader(bytes);
+    check(header.dibHeaderSize == 12, "CORE: header size");
+    check(header.width == 300, "CORE: 16-bit width");
+    check(header.height == 40000, "CORE: 16-bit height is unsigned, never top-down");
+    check(header.planes == 1 && header.bitCount == 8, "CORE: planes and bit count");
+    check(header.compression == 0 && header.colorsUsed == 0, "CORE: INFO-only fields stay zero");
+    check(header.paletteOffset == BMPFileHeaderSize + 12, "CORE: palette follows the 12-byte header");
+    check(header.paletteEntries == 10, "CORE: palette is clamped to the 3-byte entries before the pixel data");
+}
+
+void os2HeaderIsReadLikeInfo() {
+    const std::size_t dib = BMPFileHeaderSize;
+    std::vector<uint8_t> bytes = infoBmp(64, 640, 480, 4, BMPFileHeaderSize + 64 + 16 * 4);
+    put32(bytes, dib + 16, 0);
+    put32(bytes, dib + 20, 640 * 480 / 2);
+    put32(bytes, dib + 24, 2835);
+    put32(bytes, dib + 28, 2835);
+    // Fields beyond the INFO part of the OS/2 header must not be taken for masks
+    put32(bytes, dib + 40, 0xFFFFFFFF);
+
+    const BMPHeader header = parseBMPHeader(bytes);
+    check(header.dibHeaderSize == 64, "OS/2: header size");
+    check(header.width == 640 && header.height == 480, "OS/2: dimensions");
+    check(header.bitCount == 4, "OS/2: bit count");
+    check(header.imageSize == 640 * 480 / 2, "OS/2: image size");
+    check(header.xPixelsPerMeter == 2835 && header.yPixelsPerMeter == 2835, "OS/2: resolution");
+    check(header.redMask == 0 && header.greenMask == 0 && header.blueMask == 0 && header.alphaMask == 0, "OS/2: no masks");
+    check(header.paletteOffset == BMPFileHeaderSize + 64, "OS/2: palette follows the 64-byte header");
+    check(header.paletteEntries == 16, "OS/2: 4-bit images default to 16 palette entries");
+
+    const ExtractorDescriptor* extractor = ExtractorRegistry::instance().forType(FileType::BMP);
+    check(extractor && value(extractor->parse(bytes, "os2.bmp"), "DIBHeader") == "OS22XBITMAPHEADER", "OS/2: header is named");
+}
+
+void bitfieldMasksFollowInfoHeader() {
+    const std::size_t dib = BMPFileHeaderSize;
+    const std::size_t masks = dib + 40;
+    std::vector<uint8_t> bytes = infoBmp(40, 16, 16, 16, BMPFileHeaderSize + 40 + 12, 12);
+    put32(bytes, dib + 16, 3); // BI_BITFIELDS
+    put32(bytes, masks, 0xF800);
+    put32(bytes, masks + 4, 0x07E0);
+    put32(bytes, masks + 8, 0x001F);
+
+    BMPHeader header = parseBMPHeader(bytes);
+    check(header.compression == 3, "BI_BITFIELDS: compression");
+    check(header.redMask == 0xF800 && header.greenMask == 0x07E0 && header.blueMask == 0x001F, "BI_BITFIELDS: RGB565 masks");
+    check(header.alphaMask == 0, "BI_BITFIELDS: three masks, no alpha");
+    check(header.paletteOffset == BMPFileHeaderSize + 40 + 12, "BI_BITFIELDS: palette follows the masks");
+    check(header.paletteEntries == 0, "BI_BITFIELDS: 16-bit images have no palette");
+
+    bytes.resize(bytes.size() - 4);
+    check(throws(bytes), "BI_BITFIELDS: truncated masks are rejected");
+
+    // BI_ALPHABITFIELDS adds a fourth mask
+    std::vector<uint8_t> alpha = infoBmp(40, 16, 16, 32, BMPFileHeaderSize + 40 + 16, 16);
+    put32(alpha, dib + 16, 6);
+    put32(alpha, masks, 0x00FF0000);
+    put32(alpha, masks + 4, 0x0000FF00);
+    put32(alpha, masks + 8, 0x000000FF);
+    put32(alpha, masks + 12, 0xFF000000);
+    header = parseBMPHeader(alpha);
+    check(header.alphaMask == 0xFF000000, "BI_ALPHABITFIELDS: alpha mask");
+    check(header.paletteOffset == BMPFileHeaderSize + 40 + 16, "BI_ALPHABITFIELDS: palette follows four masks");
+
+    // V3 headers carry the masks themselves, so nothing trails them
+    std::vector<uint8_t> v3 = infoBmp(56, 16, 16, 32, BMPFileHeaderSize + 56);
+    put32(v3, dib + 16, 3);
+    put32(v3, masks, 0x00FF0000);
+    put32(v3, masks + 12, 0xFF000000);
+    header = parseBMPHeader(v3);
+    check(header.redMask == 0x00FF0000 && header.alphaMask == 0xFF000000, "V3: masks inside the header");
+    check(header.paletteOffset == BMPFileHeaderSize + 56, "V3: palette follows the header");
+}
+
+void negativeHeightIsTopDown() {
+    const std::vector<uint8_t> bytes = infoBmp(40, 200, -150, 24, BMPFileHeaderSize + 40);
+
+    const BMPHeader header = parseBMPHeader(bytes);
+    check(header.width == 200, "top-down: width");
+    check(header.height == -150, "top-down: height keeps its sign");
+
+    const ExtractorDescriptor* extractor = ExtractorRegistry::instance().forType(FileType::BMP);
+    const CustomMap<std::string, std::string> metadata = extractor ? extractor->parse(bytes, "top-down.bmp") : CustomMap<std::string, std::string>{};
+    check(value(metadata, "Height") == "150", "top-down: reported height is positive");
+    check(value(metadata, "Orientation") == "top-down", "top-down: orientation is reported");
+}
+
+void v5HeaderLocatesProfile() {
+    const std::vector<uint8_t> bytes = readSample("samples/1.bmp");
+    const BMPHeader header = parseBMPHeader(bytes);
+    check(header.dibHeaderSize == 124, "V5 sample: header size");
+    check(header.width == 640 && header.height == 426, "V5 sample: dimensions");
+    check(header.bitCount == 24 && header.paletteEntries == 0, "V5 sample: 24-bit, no palette");
+
+    const std::size_t dib = BMPFileHeaderSize;
+    std::vector<uint8_t> embedded = infoBmp(124, 1, 1, 32, BMPFileHeaderSize + 124);
+    put32(embedded, dib + 56, 0x4D424544); // 'MBED'
+    put32(embedded, dib + 112, 124 + 4);
+    put32(embedded, dib + 116, 3144);
+    const BMPHeader profile = parseBMPHeader(embedded);
+    check(profile.colorSpaceType == 0x4D424544, "V5: color space type");
+    check(profile.profileOffset == 128 && profile.profileSize == 3144, "V5: ICC profile offset and size");
+
+    const ExtractorDescriptor* extractor = ExtractorRegistry::instance().forType(FileType::BMP);
+    const CustomMap<std::string, std::string> metadata = extractor ? extractor->parse(embedded, "icc.bmp") : CustomMap<std::string, std::string>{};
+    check(value(metadata, "ICCProfileOffset") == std::to_string(BMPFileHeaderSize + 128), "V5: profile offset is reported from the start of the file");
+}
+
+void malformedHeadersAreRejected() {
+    check(!throws(bmp(40, 0)), "a complete INFO header parses");
+    check(throws(bmp(41, 0, 0)), "an unknown DIB header size is rejected");
+    std::vector<uint8_t> truncated = bmp(124, 0);
+    truncated.resize(BMPFileHeaderSize + 100);
+    check(throws(truncated), "a truncated V5 header is rejected");
+    check(throws(std::vector<uint8_t>{'B', 'M', 0, 0}), "a truncated file header is rejected");
+}
+
+} // namespace
+
+/**
+ * @brief BMP header decoding tests on headers built byte by byte. Run from the repository
+ * root (uses samples/).
+ */
+int main() {
+    coreHeaderHasUnsigned16BitDimensions();
+    os2HeaderIsReadLikeInfo();
+    bitfieldMasksFollowInfoHeader();
+    negativeHeightIsTopDown();
+    v5HeaderLocatesProfile();
+    malformedHeadersAreRejected();
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "All BMP header tests passed" << std::endl;
+    return 0;
+}